@@ -4,12 +4,20 @@ Generated by AI for educational purposes.
 
 Prompted / modified by Kyle Wilson. 7/28/2025.
 Makes an interactive plot of theoretical parallel speedup via Amdahl's Law.
+
+Given a CSV from scaling_runner.py, plots measured speedups instead, with
+the fitted Amdahl and Gustafson curves over them:
+
+    python3 amdahl_viz.py scaling.csv
 """
 
+import csv
+import sys
 import numpy as np
 import matplotlib.pyplot as plt
 from matplotlib.widgets import Slider, Button
 import matplotlib.patches as patches
+from scaling_runner import fit_amdahl
 
 # Set up the plotting style
 plt.style.use('default')
@@ -107,30 +115,79 @@ class ParallelScalingDemo:
         update_plot()
         
         plt.show()
-    
+
+    def measured_scaling_plot(self, csv_path):
+        """Measured strong and weak scaling from scaling_runner.py's CSV"""
+        print(f"\n=== MEASURED SCALING: {csv_path} ===")
+        with open(csv_path) as f:
+            rows = list(csv.DictReader(f))
+
+        fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(16, 7))
+        programs = sorted(set(row['program'] for row in rows))
+        max_p = max(int(row['p']) for row in rows)
+        cores = np.linspace(1, max_p, 200)
+        colors = plt.cm.tab10(np.arange(len(programs)) % 10)
+
+        for program, color in zip(programs, colors):
+            for scaling, ax in (('strong', ax1), ('weak', ax2)):
+                data = [row for row in rows if row['program'] == program and row['scaling'] == scaling]
+                if not data:
+                    continue
+                p = np.array([int(row['p']) for row in data], dtype=float)
+                speedup = np.array([float(row['speedup']) for row in data])
+
+                if scaling == 'strong':
+                    f = fit_amdahl(zip(p, speedup))
+                    ax.plot(cores, self.amdahl_speedup(cores, f), '-', color=color, alpha=0.6)
+                    label = f'{program} (fitted f = {f:.3f})'
+                    print(f"{program}: Amdahl serial fraction {f:.4f}")
+                else:
+                    # Gustafson: S = p - a (p - 1), least squares for a
+                    a = np.sum((p - speedup) * (p - 1)) / max(np.sum((p - 1) ** 2), 1e-12)
+                    ax.plot(cores, cores - a * (cores - 1), '-', color=color, alpha=0.6)
+                    label = f'{program} (fitted a = {a:.3f})'
+                    print(f"{program}: Gustafson serial fraction {a:.4f}")
+                ax.plot(p, speedup, 'o', color=color, label=label)
+
+        for ax, title, ylabel in ((ax1, 'Strong scaling: measured vs. Amdahl fit', 'Speedup'),
+                                  (ax2, 'Weak scaling: measured vs. Gustafson fit', 'Scaled speedup')):
+            ax.plot(cores, cores, 'k--', alpha=0.5, label='Ideal speedup')
+            ax.set_xlabel('Number of Cores (threads or ranks)')
+            ax.set_ylabel(ylabel)
+            ax.set_title(title)
+            ax.grid(True, alpha=0.3)
+            ax.legend(fontsize=8)
+            ax.set_xlim(1, max_p)
+
+        plt.tight_layout()
+        plt.show()
 
 
+if __name__ == "__main__":
+    # Create the demo instance
+    demo = ParallelScalingDemo()
 
-# Create the demo instance
-demo = ParallelScalingDemo()
+    if len(sys.argv) > 1:
+        demo.measured_scaling_plot(sys.argv[1])
+        sys.exit(0)
 
-# Test if matplotlib interactive backend is working
-print("Testing matplotlib backend...")
-print(f"Current backend: {plt.get_backend()}")
-print("If you see 'Agg', interactive plots may not work in your environment.\n")
+    # Test if matplotlib interactive backend is working
+    print("Testing matplotlib backend...")
+    print(f"Current backend: {plt.get_backend()}")
+    print("If you see 'Agg', interactive plots may not work in your environment.\n")
 
-# Run interactive demo
-try:
-    demo.strong_scaling_demo_interactive()
-    print("\nInteractive demo completed successfully!")
-except Exception as e:
-    print(f"\nInteractive plot failed: {e}")
-    print("You may need to enable interactive matplotlib backend.")
+    # Run interactive demo
+    try:
+        demo.strong_scaling_demo_interactive()
+        print("\nInteractive demo completed successfully!")
+    except Exception as e:
+        print(f"\nInteractive plot failed: {e}")
+        print("You may need to enable interactive matplotlib backend.")
 
-print("\n" + "="*60)
-print("DISCUSSION QUESTIONS FOR STUDENTS:")
-print("="*60)
-print("""
+    print("\n" + "="*60)
+    print("DISCUSSION QUESTIONS FOR STUDENTS:")
+    print("="*60)
+    print("""
 1. What happens to speedup as the serial fraction increases?
    → Even small serial fractions (5-10%) dramatically limit scalability
 
@@ -0,0 +1,226 @@
+"""
+MEASURED SCALING RUNNER
+
+Runs the repo's parallel programs at 1, 2, 4, ... P threads (or MPI ranks),
+times them, and writes the results to a CSV file that amdahl_viz.py can plot:
+
+    python3 scaling_runner.py                      # everything, up to all cores
+    python3 scaling_runner.py --max-p 16 --only fib_scan,lu_throughput
+    python3 amdahl_viz.py scaling.csv              # on your own machine
+
+Two kinds of runs:
+
+  strong   Same problem at every p. speedup = T(1) / T(p).
+           Karp-Flatt metric: the serial fraction that would explain each
+           measured speedup,   e = (1/S - 1/p) / (1 - 1/p)
+           If e stays flat as p grows, the program really does have a serial
+           part of that size (Amdahl). If e grows, something else is eating
+           the speedup: communication, synchronization, load imbalance.
+
+  weak     Problem grows with p. scaled speedup = p * T(1) / T(p), which is
+           what Gustafson's law talks about:  S = p - a (p - 1),
+           so each run gives a serial fraction a = (p - S) / (p - 1).
+
+We also fit a single Amdahl serial fraction to all the strong-scaling points
+(least squares on 1/S = f + (1 - f)/p), which is the curve amdahl_viz.py
+draws through the measurements.
+
+Times are the parallel section only, as each program reports it. Several
+of the demos also run a serial reference pass (to check the answer, or to
+compute their own speedup) at every p; timing the whole process would
+count that fixed work as "serial fraction" and hide the real bottlenecks.
+Programs that don't report a time (factorize) are timed as a whole process.
+
+Only uses the standard library, so it runs on the cluster as is.
+"""
+
+import argparse
+import csv
+import os
+import re
+import subprocess
+import sys
+import time
+
+REPO = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+
+# Read the parallel time, in seconds, out of each program's output.
+# Each returns None if the output doesn't look as expected.
+
+def philox_time(output):
+    # The "--- Parallel (p threads) ---" section's "Time: ... seconds"
+    match = re.search(r"--- Parallel.*?Time: ([\d.]+) seconds", output, re.S)
+    return float(match.group(1)) if match else None
+
+
+def bulk_time(output):
+    # Sum of the bulk generator rows' "Time (s)" column (rand_r is skipped)
+    times = [float(line.split()[-3]) for line in output.splitlines() if line.startswith("bulk ")]
+    return sum(times) if times else None
+
+
+def scan_time(output):
+    # Sum of the "Scan (s)" column, which follows the "Serial (s)" one
+    times = [float(m.group(1)) for m in
+             re.finditer(r"^\S.*?\s[\d.]+\s+([\d.]+)\s+[\d.]+x", output, re.M)]
+    return sum(times) if times else None
+
+
+def throughput_time(output):
+    # Systems / (systems per second) for the arena version
+    systems = re.search(r"Throughput mode: (\d+) systems", output)
+    rate = re.search(r"^arena\s+([\d.]+)", output, re.M)
+    return int(systems.group(1)) / float(rate.group(1)) if systems and rate else None
+
+
+# name: (directory, kind, strong-scaling command, weak-scaling command, parser)
+# Each command is a function of p, the thread/rank count. Weak-scaling
+# commands grow the problem with p. With no parser, we time the whole process.
+PROGRAMS = {
+    "rng_philox": ("unit4-openmp/rng", "omp",
+                   lambda p: f"./rng_demo_philox {p} 200000000",
+                   lambda p: f"./rng_demo_philox {p} {50000000 * p}",
+                   philox_time),
+    "rng_bulk": ("unit4-openmp/rng", "omp",
+                 lambda p: f"./rng_bulk_demo {p} {400000000 // p}",
+                 lambda p: f"./rng_bulk_demo {p} 100000000",
+                 bulk_time),
+    "fib_scan": ("unit4-openmp/fib", "omp",
+                 lambda p: f"./fib_scan {p} 50000000",
+                 lambda p: f"./fib_scan {p} {12500000 * p}",
+                 scan_time),
+    "lu_throughput": ("unit2-serial/profiling", "omp",
+                      lambda p: f"./lu_demo throughput {p} 2000 100",
+                      lambda p: f"./lu_demo throughput {p} {500 * p} 100",
+                      throughput_time),
+    "factorize": ("unit3-mpi/factorize", "mpi",
+                  lambda p: "./factorize",
+                  None,
+                  None),
+}
+
+
+def fit_amdahl(points):
+    """Least-squares serial fraction f from (p, speedup) pairs.
+    1/S - 1/p = f (1 - 1/p) is a line through the origin in f.
+    amdahl_viz.py imports this to draw its fitted curves."""
+    num = den = 0.0
+    for p, s in points:
+        if p > 1:
+            a = 1 - 1 / p
+            num += a * (1 / s - 1 / p)
+            den += a * a
+    return num / den if den > 0 else 0.0
+
+
+def thread_counts(max_p):
+    counts, p = [], 1
+    while p < max_p:
+        counts.append(p)
+        p *= 2
+    counts.append(max_p)
+    return counts
+
+
+def run(directory, kind, command, parse, p, reps, mpirun):
+    """Best time of `reps` runs, or None if the program failed. The time is
+    what parse() finds in the output, or the wall time if there's no parser."""
+    args = command.split()
+    env = dict(os.environ)
+    if kind == "omp":
+        env["OMP_NUM_THREADS"] = str(p)
+    else:
+        args = mpirun.split() + ["-n", str(p)] + args
+
+    best = None
+    for _ in range(reps):
+        start = time.perf_counter()
+        result = subprocess.run(args, cwd=os.path.join(REPO, directory), env=env,
+                                stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        elapsed = time.perf_counter() - start
+        if result.returncode != 0:
+            print(f"    failed: {' '.join(args)}\n    {result.stderr.decode().strip()[:200]}")
+            return None
+        if parse is not None:
+            elapsed = parse(result.stdout.decode())
+            if elapsed is None:
+                print(f"    no time found in the output of: {' '.join(args)}")
+                return None
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure strong and weak scaling")
+    parser.add_argument("--max-p", type=int, default=os.cpu_count(),
+                        help="largest thread/rank count (default: all cores)")
+    parser.add_argument("--reps", type=int, default=3, help="runs per point; best is kept")
+    parser.add_argument("--only", default="", help="comma-separated program names")
+    parser.add_argument("--out", default="scaling.csv", help="CSV file to write")
+    parser.add_argument("--mpirun", default="mpiexec", help="MPI launcher")
+    args = parser.parse_args()
+
+    names = args.only.split(",") if args.only else list(PROGRAMS)
+    for name in names:
+        if name not in PROGRAMS:
+            sys.exit(f"Unknown program '{name}'. Choices: {', '.join(PROGRAMS)}")
+
+    rows = []
+    for name in names:
+        directory, kind, strong, weak, parse = PROGRAMS[name]
+        print(f"\n=== {name} ({kind}) ===")
+        if subprocess.run(["make", "-C", os.path.join(REPO, directory)],
+                          stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL).returncode != 0:
+            print("    build failed, skipping")
+            continue
+
+        for scaling, command in (("strong", strong), ("weak", weak)):
+            if command is None:
+                continue
+            print(f"  {scaling} scaling: {command(1)} ... {command(args.max_p)}")
+            print(f"  {'p':>5} {'seconds':>10} {'speedup':>9} {'effic.':>8} {'serial frac.':>13}")
+
+            t1 = None
+            points = []
+            for p in thread_counts(args.max_p):
+                seconds = run(directory, kind, command(p), parse, p, args.reps, args.mpirun)
+                if seconds is None:
+                    break
+                if p == 1:
+                    t1 = seconds
+                speedup = t1 / seconds if scaling == "strong" else p * t1 / seconds
+
+                # Karp-Flatt for strong scaling, Gustafson's serial fraction for weak
+                if p == 1:
+                    serial = ""
+                elif scaling == "strong":
+                    serial = f"{(1 / speedup - 1 / p) / (1 - 1 / p):.4f}"
+                else:
+                    serial = f"{(p - speedup) / (p - 1):.4f}"
+
+                print(f"  {p:5d} {seconds:10.3f} {speedup:9.2f} {100 * speedup / p:7.1f}% {serial:>13}")
+                rows.append({"program": name, "scaling": scaling, "p": p,
+                             "seconds": f"{seconds:.6f}", "speedup": f"{speedup:.4f}",
+                             "efficiency": f"{speedup / p:.4f}", "serial_fraction": serial})
+                points.append((p, speedup))
+
+            if scaling == "strong" and len(points) > 1:
+                f = fit_amdahl(points)
+                if f <= 0:
+                    limit = "no serial part"
+                elif f < 1:
+                    limit = f"max speedup {1 / f:.1f}x"
+                else:
+                    limit = "no speedup at all"
+                print(f"  Fitted Amdahl serial fraction: {f:.4f} ({limit})")
+
+    with open(args.out, "w", newline="") as out:
+        writer = csv.DictWriter(out, fieldnames=["program", "scaling", "p", "seconds", "speedup",
+                                                 "efficiency", "serial_fraction"])
+        writer.writeheader()
+        writer.writerows(rows)
+    print(f"\nWrote {args.out}. Plot it with: python3 amdahl_viz.py {args.out}")
+
+
+if __name__ == "__main__":
+    main()
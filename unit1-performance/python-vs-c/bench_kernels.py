@@ -0,0 +1,218 @@
+"""
+Calling C from Python: what does a call cost?
+
+Build the extension with `make`, then run
+
+    python3 bench_kernels.py
+
+Each section does the same job three ways:
+
+  1. pure Python
+  2. one call into C per element (or per small problem)
+  3. one call into C for the whole batch
+
+Every call from Python into C pays a fixed cost: looking up the function,
+parsing the arguments, checking the buffers, dropping and retaking the GIL.
+Way 2 pays it every time; way 3 pays it once. The C kernels themselves are
+the same in both.
+
+Arrays go to C through the buffer protocol, so NumPy float64 arrays are
+used in place, without copying. If NumPy isn't installed, array('d') from
+the standard library works too.
+"""
+
+import array
+import threading
+import time
+
+import ckernels
+
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+
+def doubles(n, value=0.0):
+    """A buffer of n doubles: NumPy if we have it, array('d') otherwise"""
+    if np is not None:
+        return np.full(n, value, dtype=np.float64)
+    return array.array("d", [value]) * n
+
+
+def best_time(func, reps=5):
+    """Best of `reps` runs, in seconds"""
+    best = None
+    for _ in range(reps):
+        start = time.perf_counter()
+        func()
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+
+def report(label, seconds, count, unit):
+    print(f"  {label:<40} {seconds * 1e9 / count:10.1f} ns/{unit}")
+
+
+def bench_call_overhead(n):
+    print(f"\nAdding two arrays of {n} doubles")
+    x, y, out = doubles(n, 1.5), doubles(n, 2.5), doubles(n)
+    xs, ys = list(x), list(y)
+
+    def pure_python():
+        return [a + b for a, b in zip(xs, ys)]
+
+    def one_call_per_element():
+        add = ckernels.add_doubles
+        return [add(a, b) for a, b in zip(xs, ys)]
+
+    def one_call():
+        ckernels.add_arrays(x, y, out)
+
+    report("pure Python", best_time(pure_python), n, "element")
+    report("ckernels.add_doubles, once per element", best_time(one_call_per_element), n, "element")
+    report("ckernels.add_arrays, one call", best_time(one_call), n, "element")
+
+
+def bench_reductions(n, pieces):
+    print(f"\nReducing {n} doubles (the kernels from pipeline_demo.c)")
+    x = doubles(n, 1.0)
+    xs = list(x)
+
+    def pure_python():
+        total = 0.0
+        for v in xs:
+            total = total + v
+            total = total * 1.0000001
+            total = total - 0.0000001
+        return total
+
+    report("pure Python loop", best_time(pure_python, 3), n, "element")
+    report("built-in sum()", best_time(lambda: sum(xs)), n, "element")
+    for name in ("sum_with_dependencies", "sum_independent_accumulators", "sum_unrolled"):
+        kernel = getattr(ckernels, name)
+        report(f"ckernels.{name}", best_time(lambda: kernel(x)), n, "element")
+
+    # Many short reductions: one call per piece, or one batched call.
+    # memoryview slices share memory with x, so nothing is copied here either.
+    length = n // pieces
+    view = memoryview(x).cast("B").cast("d")
+    slices = [view[i * length:(i + 1) * length] for i in range(pieces)]
+    out = doubles(pieces)
+    print(f"\n{pieces} reductions of {length} doubles each")
+
+    def one_call_per_piece():
+        return [ckernels.sum_unrolled(s) for s in slices]
+
+    report("sum_unrolled, once per piece", best_time(one_call_per_piece), pieces, "piece")
+    report("sum_unrolled_batch, one call",
+           best_time(lambda: ckernels.sum_unrolled_batch(view[:length * pieces], out)),
+           pieces, "piece")
+
+
+def random_systems(n, count, seed=1):
+    """count diagonally dominant n x n matrices (safe without pivoting) and right-hand sides"""
+    state = seed
+    A, B = doubles(n * n * count), doubles(n * count)
+    for m in range(count):
+        for k in range(n * n):
+            state = (state * 1103515245 + 12345) % 2**31
+            A[m * n * n + k] = state / 2**31
+        for i in range(n):
+            A[m * n * n + i + i * n] += n
+            B[m * n + i] = 1.0
+    return A, B
+
+
+def python_lu_solve(A, b, n):
+    """The same algorithm in pure Python, on lists, for comparison"""
+    A = list(A)
+    for d in range(n - 1):
+        for r in range(d + 1, n):
+            A[r + d * n] /= A[d + d * n]
+        for c in range(d + 1, n):
+            u = A[d + c * n]
+            for r in range(d + 1, n):
+                A[r + c * n] -= A[r + d * n] * u
+    x = list(b)
+    for i in range(n):
+        for j in range(i):
+            x[i] -= A[i + j * n] * x[j]
+    for i in range(n - 1, -1, -1):
+        for j in range(i + 1, n):
+            x[i] -= A[i + j * n] * x[j]
+        x[i] /= A[i + i * n]
+    return x
+
+
+def bench_lu(n, count):
+    print(f"\nFactoring and solving {count} systems of size {n}")
+    A0, B = random_systems(n, count)
+    X = doubles(n * count)
+    view_a = memoryview(A0).cast("B").cast("d")
+
+    def copy_of_a():
+        A = doubles(n * n * count)
+        memoryview(A).cast("B")[:] = memoryview(A0).cast("B")
+        return A
+
+    def pure_python():
+        for m in range(min(count, 50)):
+            python_lu_solve(view_a[m * n * n:(m + 1) * n * n], B[m * n:(m + 1) * n], n)
+
+    def one_call_per_system():
+        A = copy_of_a()
+        va, vb, vx = (memoryview(buf).cast("B").cast("d") for buf in (A, B, X))
+        for m in range(count):
+            ckernels.lu_factor(va[m * n * n:(m + 1) * n * n])
+            ckernels.lu_solve(va[m * n * n:(m + 1) * n * n], vb[m * n:(m + 1) * n],
+                              vx[m * n:(m + 1) * n])
+
+    def batched():
+        A = copy_of_a()
+        ckernels.lu_factor_batch(A, count)
+        ckernels.lu_solve_batch(A, B, X, count)
+
+    report("pure Python", best_time(pure_python, 1), min(count, 50), "system")
+    report("lu_factor + lu_solve, once per system", best_time(one_call_per_system), count, "system")
+    report("lu_factor_batch + lu_solve_batch", best_time(batched), count, "system")
+
+    # Check the answer: A x should be b
+    worst = 0.0
+    for m in range(count):
+        for i in range(n):
+            row = sum(A0[m * n * n + i + j * n] * X[m * n + j] for j in range(n))
+            worst = max(worst, abs(row - B[m * n + i]))
+    print(f"  largest residual |Ax - b|: {worst:.2e}")
+
+
+def bench_threads(n, nthreads):
+    """The kernels drop the GIL, so Python threads calling them run at the same time"""
+    print(f"\nsum_with_dependencies on {n} doubles, from {nthreads} Python threads")
+    x = doubles(n, 1.0)
+
+    def work():
+        ckernels.sum_with_dependencies(x)
+
+    serial = best_time(lambda: [work() for _ in range(nthreads)], 3)
+
+    def threaded():
+        threads = [threading.Thread(target=work) for _ in range(nthreads)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+    parallel = best_time(threaded, 3)
+    print(f"  one after another: {serial:.3f} s")
+    print(f"  in {nthreads} threads:      {parallel:.3f} s  (speedup {serial / parallel:.2f}x, "
+          f"limited by your core count)")
+
+
+if __name__ == "__main__":
+    print("Arrays are", "NumPy float64" if np is not None else "array('d') (NumPy not found)")
+    bench_call_overhead(1_000_000)
+    bench_reductions(10_000_000, 100_000)
+    bench_lu(8, 10_000)
+    bench_threads(50_000_000, 4)
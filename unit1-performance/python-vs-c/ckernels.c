@@ -0,0 +1,407 @@
+// ckernels.c: the repo's C kernels, callable from Python
+//
+// Build with `make`, then in Python:
+//
+//     import ckernels
+//     ckernels.add_numbers(5, 3)
+//
+// Arrays are passed through the buffer protocol: anything that exposes a
+// C-contiguous block of doubles works (a NumPy float64 array, array('d'),
+// a memoryview of either). We read and write that memory directly, with
+// no copying, and release the GIL while we compute, so other Python
+// threads can run - including other calls into this module.
+//
+// Every kernel also comes in a batched form that does many problems in
+// one call, since the fixed cost of a call from Python (argument parsing,
+// buffer checks, the GIL) can be more than the work for a small problem.
+// bench_kernels.py measures that cost.
+//
+// Matrices are column-major, like lu_demo.c: A[r,c] is A[r + c*n].
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <math.h>
+#include <string.h>
+
+/* ---------- The kernels (plain C, no Python) ---------- */
+
+int add_numbers(int a, int b) {
+    return a + b;
+}
+
+// lu_factorize_serial from unit2-serial/profiling/lu_demo.c, with the
+// loops turned so the inner one runs down a column (unit stride).
+// Returns the first zero pivot's index, or -1 if there wasn't one.
+static long lu_factorize(double *A, long n) {
+    for (long d = 0; d < n - 1; ++d) {
+        if (A[d + d * n] == 0.0)
+            return d;
+        for (long r = d + 1; r < n; ++r)
+            A[r + d * n] /= A[d + d * n];
+        for (long c = d + 1; c < n; ++c) {
+            double u = A[d + c * n];
+            for (long r = d + 1; r < n; ++r)
+                A[r + c * n] -= A[r + d * n] * u;
+        }
+    }
+    return (n > 0 && A[(n - 1) + (n - 1) * n] == 0.0) ? n - 1 : -1;
+}
+
+// solve_lu_system from lu_demo.c, without the scratch vector: forward
+// substitution can work in x directly
+static void lu_solve(const double *LU, const double *b, double *x, long n) {
+    for (long i = 0; i < n; ++i) {
+        x[i] = b[i];
+        for (long j = 0; j < i; ++j)
+            x[i] -= LU[i + j * n] * x[j];
+    }
+    for (long i = n - 1; i >= 0; --i) {
+        for (long j = i + 1; j < n; ++j)
+            x[i] -= LU[i + j * n] * x[j];
+        x[i] /= LU[i + i * n];
+    }
+}
+
+// The three reduction kernels from unit2-serial/pipelining/pipeline_demo.c
+static double sum_with_dependencies(const double *arr, long size) {
+    double sum = 0.0;
+    for (long i = 0; i < size; i++) {
+        sum = sum + arr[i];
+        sum = sum * 1.0000001;
+        sum = sum - 0.0000001;
+    }
+    return sum;
+}
+
+static double sum_independent_accumulators(const double *arr, long size) {
+    double sum1 = 0.0, sum2 = 0.0;
+    long i;
+    for (i = 0; i < size - 1; i += 2) {
+        sum1 = sum1 + arr[i];
+        sum2 = sum2 + arr[i+1];
+        sum1 = sum1 * 1.0000001;
+        sum2 = sum2 * 1.0000001;
+        sum1 = sum1 - 0.0000001;
+        sum2 = sum2 - 0.0000001;
+    }
+    for (; i < size; i++) {
+        sum1 = sum1 + arr[i];
+        sum1 = sum1 * 1.0000001;
+        sum1 = sum1 - 0.0000001;
+    }
+    return sum1 + sum2;
+}
+
+static double sum_unrolled(const double *arr, long size) {
+    double sum1 = 0.0, sum2 = 0.0, sum3 = 0.0, sum4 = 0.0;
+    double sum5 = 0.0, sum6 = 0.0, sum7 = 0.0, sum8 = 0.0;
+    long i;
+    for (i = 0; i < size - 7; i += 8) {
+        sum1 += arr[i] * 1.0000001 - 0.0000001;
+        sum2 += arr[i+1] * 1.0000001 - 0.0000001;
+        sum3 += arr[i+2] * 1.0000001 - 0.0000001;
+        sum4 += arr[i+3] * 1.0000001 - 0.0000001;
+        sum5 += arr[i+4] * 1.0000001 - 0.0000001;
+        sum6 += arr[i+5] * 1.0000001 - 0.0000001;
+        sum7 += arr[i+6] * 1.0000001 - 0.0000001;
+        sum8 += arr[i+7] * 1.0000001 - 0.0000001;
+    }
+    for (; i < size; i++)
+        sum1 += arr[i] * 1.0000001 - 0.0000001;
+    return sum1 + sum2 + sum3 + sum4 + sum5 + sum6 + sum7 + sum8;
+}
+
+
+/* ---------- Buffers ---------- */
+
+// Get a contiguous double buffer from obj, or set an exception and return -1.
+// Release it with PyBuffer_Release.
+static int get_doubles(PyObject *obj, Py_buffer *view, int writable, const char *name) {
+    int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+    if (PyObject_GetBuffer(obj, view, flags) < 0) {
+        PyErr_Format(PyExc_TypeError, "%s must be a %scontiguous buffer of doubles",
+                     name, writable ? "writable " : "");
+        return -1;
+    }
+    if (view->itemsize != sizeof(double) || !view->format || strcmp(view->format, "d") != 0) {
+        PyErr_Format(PyExc_TypeError, "%s must hold doubles (format 'd', e.g. float64)", name);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+static Py_ssize_t num_doubles(const Py_buffer *view) {
+    return view->len / sizeof(double);
+}
+
+// n >= 1 for a buffer holding `count` n x n matrices, or -1 (with an
+// exception). Checking total / count first keeps n * n * count from
+// overflowing, and an empty buffer can't pass for any number of 0 x 0s.
+static long matrix_size(const Py_buffer *view, long count, const char *name) {
+    Py_ssize_t total = num_doubles(view);
+    long n = 0;
+    if (count > 0 && total > 0 && total % count == 0) {
+        long per_matrix = total / count;
+        n = (long)sqrt((double)per_matrix);
+        while ((n + 1) * (n + 1) <= per_matrix) n++;
+        while (n > 0 && n * n > per_matrix) n--;
+        if (n * n != per_matrix)
+            n = 0;
+    }
+    if (n < 1) {
+        PyErr_Format(PyExc_ValueError, "%s must hold count=%ld n x n matrices", name, count);
+        return -1;
+    }
+    return n;
+}
+
+
+/* ---------- Python wrappers ---------- */
+
+static PyObject *py_add_numbers(PyObject *self, PyObject *args) {
+    int a, b;
+    if (!PyArg_ParseTuple(args, "ii", &a, &b))
+        return NULL;
+    return PyLong_FromLong(add_numbers(a, b));
+}
+
+// The same for doubles, to compare one call per element with add_arrays
+static PyObject *py_add_doubles(PyObject *self, PyObject *args) {
+    double a, b;
+    if (!PyArg_ParseTuple(args, "dd", &a, &b))
+        return NULL;
+    return PyFloat_FromDouble(a + b);
+}
+
+// add_arrays(x, y, out): out[i] = x[i] + y[i]
+static PyObject *py_add_arrays(PyObject *self, PyObject *args) {
+    PyObject *xo, *yo, *outo;
+    Py_buffer x, y, out;
+    if (!PyArg_ParseTuple(args, "OOO", &xo, &yo, &outo))
+        return NULL;
+    if (get_doubles(xo, &x, 0, "x") < 0)
+        return NULL;
+    if (get_doubles(yo, &y, 0, "y") < 0) {
+        PyBuffer_Release(&x);
+        return NULL;
+    }
+    if (get_doubles(outo, &out, 1, "out") < 0) {
+        PyBuffer_Release(&x);
+        PyBuffer_Release(&y);
+        return NULL;
+    }
+
+    PyObject *result = NULL;
+    Py_ssize_t n = num_doubles(&out);
+    if (num_doubles(&x) != n || num_doubles(&y) != n) {
+        PyErr_SetString(PyExc_ValueError, "x, y and out must be the same length");
+    } else {
+        const double *xp = x.buf, *yp = y.buf;
+        double *op = out.buf;
+        Py_BEGIN_ALLOW_THREADS
+        for (Py_ssize_t i = 0; i < n; i++)
+            op[i] = xp[i] + yp[i];
+        Py_END_ALLOW_THREADS
+        result = Py_NewRef(Py_None);
+    }
+    PyBuffer_Release(&x);
+    PyBuffer_Release(&y);
+    PyBuffer_Release(&out);
+    return result;
+}
+
+// lu_factor_batch(A, count): factor `count` n x n matrices stored one after
+// another, in place. lu_factor(A) is the same with count = 1.
+static PyObject *factor_matrices(PyObject *obj, long count) {
+    Py_buffer A;
+    if (get_doubles(obj, &A, 1, "A") < 0)
+        return NULL;
+    long n = matrix_size(&A, count, "A");
+    if (n < 0) {
+        PyBuffer_Release(&A);
+        return NULL;
+    }
+
+    long bad_matrix = -1, bad_pivot = -1;
+    double *base = A.buf;
+    Py_BEGIN_ALLOW_THREADS
+    for (long m = 0; m < count; m++) {
+        long pivot = lu_factorize(base + m * n * n, n);
+        if (pivot >= 0) {
+            bad_matrix = m;
+            bad_pivot = pivot;
+            break;
+        }
+    }
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&A);
+
+    if (bad_matrix >= 0) {
+        PyErr_Format(PyExc_ZeroDivisionError,
+                     "zero pivot at row %ld of matrix %ld (no pivoting)", bad_pivot, bad_matrix);
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *py_lu_factor(PyObject *self, PyObject *args) {
+    PyObject *obj;
+    if (!PyArg_ParseTuple(args, "O", &obj))
+        return NULL;
+    return factor_matrices(obj, 1);
+}
+
+static PyObject *py_lu_factor_batch(PyObject *self, PyObject *args) {
+    PyObject *obj;
+    long count;
+    if (!PyArg_ParseTuple(args, "Ol", &obj, &count))
+        return NULL;
+    return factor_matrices(obj, count);
+}
+
+// lu_solve_batch(LU, B, X, count): X[m] = A[m]^-1 B[m] for each system
+static PyObject *solve_systems(PyObject *luo, PyObject *bo, PyObject *xo, long count) {
+    Py_buffer LU, B, X;
+    if (get_doubles(luo, &LU, 0, "LU") < 0)
+        return NULL;
+    if (get_doubles(bo, &B, 0, "b") < 0) {
+        PyBuffer_Release(&LU);
+        return NULL;
+    }
+    if (get_doubles(xo, &X, 1, "x") < 0) {
+        PyBuffer_Release(&LU);
+        PyBuffer_Release(&B);
+        return NULL;
+    }
+
+    PyObject *result = NULL;
+    long n = matrix_size(&LU, count, "LU");
+    if (n >= 0) {
+        if (num_doubles(&B) != n * count || num_doubles(&X) != n * count) {
+            PyErr_Format(PyExc_ValueError, "b and x must hold %ld vectors of length %ld",
+                         count, n);
+        } else {
+            const double *lu = LU.buf, *b = B.buf;
+            double *x = X.buf;
+            Py_BEGIN_ALLOW_THREADS
+            for (long m = 0; m < count; m++)
+                lu_solve(lu + m * n * n, b + m * n, x + m * n, n);
+            Py_END_ALLOW_THREADS
+            result = Py_NewRef(Py_None);
+        }
+    }
+    PyBuffer_Release(&LU);
+    PyBuffer_Release(&B);
+    PyBuffer_Release(&X);
+    return result;
+}
+
+static PyObject *py_lu_solve(PyObject *self, PyObject *args) {
+    PyObject *lu, *b, *x;
+    if (!PyArg_ParseTuple(args, "OOO", &lu, &b, &x))
+        return NULL;
+    return solve_systems(lu, b, x, 1);
+}
+
+static PyObject *py_lu_solve_batch(PyObject *self, PyObject *args) {
+    PyObject *lu, *b, *x;
+    long count;
+    if (!PyArg_ParseTuple(args, "OOOl", &lu, &b, &x, &count))
+        return NULL;
+    return solve_systems(lu, b, x, count);
+}
+
+// The reductions: one function per kernel, plus a batched version that
+// reduces each of `count` equal-length pieces into out
+typedef double (*reduction)(const double *, long);
+
+static PyObject *reduce(PyObject *args, reduction kernel) {
+    PyObject *obj;
+    Py_buffer x;
+    if (!PyArg_ParseTuple(args, "O", &obj) || get_doubles(obj, &x, 0, "x") < 0)
+        return NULL;
+    double sum;
+    Py_BEGIN_ALLOW_THREADS
+    sum = kernel(x.buf, num_doubles(&x));
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&x);
+    return PyFloat_FromDouble(sum);
+}
+
+static PyObject *py_sum_with_dependencies(PyObject *self, PyObject *args) {
+    return reduce(args, sum_with_dependencies);
+}
+
+static PyObject *py_sum_independent_accumulators(PyObject *self, PyObject *args) {
+    return reduce(args, sum_independent_accumulators);
+}
+
+static PyObject *py_sum_unrolled(PyObject *self, PyObject *args) {
+    return reduce(args, sum_unrolled);
+}
+
+static PyObject *py_sum_unrolled_batch(PyObject *self, PyObject *args) {
+    PyObject *xo, *outo;
+    Py_buffer x, out;
+    if (!PyArg_ParseTuple(args, "OO", &xo, &outo) || get_doubles(xo, &x, 0, "x") < 0)
+        return NULL;
+    if (get_doubles(outo, &out, 1, "out") < 0) {
+        PyBuffer_Release(&x);
+        return NULL;
+    }
+
+    PyObject *result = NULL;
+    long count = num_doubles(&out);
+    if (count == 0 || num_doubles(&x) % count != 0) {
+        PyErr_SetString(PyExc_ValueError, "len(x) must be a multiple of len(out)");
+    } else {
+        long len = num_doubles(&x) / count;
+        const double *xp = x.buf;
+        double *op = out.buf;
+        Py_BEGIN_ALLOW_THREADS
+        for (long m = 0; m < count; m++)
+            op[m] = sum_unrolled(xp + m * len, len);
+        Py_END_ALLOW_THREADS
+        result = Py_NewRef(Py_None);
+    }
+    PyBuffer_Release(&x);
+    PyBuffer_Release(&out);
+    return result;
+}
+
+static PyMethodDef ckernels_methods[] = {
+    {"add_numbers", py_add_numbers, METH_VARARGS,
+     "add_numbers(a, b) -> a + b, like add.c"},
+    {"add_doubles", py_add_doubles, METH_VARARGS,
+     "add_doubles(a, b) -> a + b, for floats"},
+    {"add_arrays", py_add_arrays, METH_VARARGS,
+     "add_arrays(x, y, out): out[i] = x[i] + y[i]"},
+    {"lu_factor", py_lu_factor, METH_VARARGS,
+     "lu_factor(A): LU-factor the n x n column-major matrix A in place (no pivoting)"},
+    {"lu_factor_batch", py_lu_factor_batch, METH_VARARGS,
+     "lu_factor_batch(A, count): factor count n x n matrices stored back to back"},
+    {"lu_solve", py_lu_solve, METH_VARARGS,
+     "lu_solve(LU, b, x): solve A x = b given lu_factor's result"},
+    {"lu_solve_batch", py_lu_solve_batch, METH_VARARGS,
+     "lu_solve_batch(LU, B, X, count): count solves, one per factored matrix"},
+    {"sum_with_dependencies", py_sum_with_dependencies, METH_VARARGS,
+     "pipeline_demo's version 1: one dependency chain"},
+    {"sum_independent_accumulators", py_sum_independent_accumulators, METH_VARARGS,
+     "pipeline_demo's version 2: two accumulators"},
+    {"sum_unrolled", py_sum_unrolled, METH_VARARGS,
+     "pipeline_demo's version 3: eight accumulators"},
+    {"sum_unrolled_batch", py_sum_unrolled_batch, METH_VARARGS,
+     "sum_unrolled_batch(x, out): sum_unrolled of each of len(out) equal pieces of x"},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef ckernels_module = {
+    PyModuleDef_HEAD_INIT, "ckernels",
+    "C kernels from this repo, over the buffer protocol, with the GIL released",
+    -1, ckernels_methods
+};
+
+PyMODINIT_FUNC PyInit_ckernels(void) {
+    return PyModule_Create(&ckernels_module);
+}
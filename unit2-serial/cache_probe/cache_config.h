@@ -0,0 +1,82 @@
+#ifndef CACHE_CONFIG_H
+#define CACHE_CONFIG_H
+
+/*
+ * Cache sizes for choosing block sizes, read once at startup.
+ *
+ * cache_probe measures the *effective* size of each cache level (where
+ * load latency actually jumps) and writes them to cache.conf:
+ *
+ *     l1_bytes=49152
+ *     l2_bytes=1572864
+ *     ...
+ *
+ * cache_config_load() looks for that file in this order:
+ *
+ *     1. the path in the CACHE_CONFIG environment variable
+ *     2. ./cache.conf
+ *     3. ../cache_probe/cache.conf   (for the other unit2-serial demos)
+ *
+ * Any level the file doesn't give falls back to the nominal size from
+ * sysconf (what `getconf -a | grep CACHE` prints), and then to a guess.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct {
+    long l1_bytes;
+    long l2_bytes;
+    long l3_bytes;
+    char source[256];   // where the numbers came from, for printing
+} cache_config;
+
+static inline int cache_config_read_file(cache_config *c, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return 0;
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char key[64];
+        long value;
+        if (line[0] == '#' || sscanf(line, " %63[a-z0-9_] = %ld", key, &value) != 2)
+            continue;
+        if (strcmp(key, "l1_bytes") == 0) c->l1_bytes = value;
+        if (strcmp(key, "l2_bytes") == 0) c->l2_bytes = value;
+        if (strcmp(key, "l3_bytes") == 0) c->l3_bytes = value;
+    }
+    fclose(f);
+    snprintf(c->source, sizeof(c->source), "measured (%s)", path);
+    return 1;
+}
+
+static inline void cache_config_load(cache_config *c) {
+    memset(c, 0, sizeof(*c));
+
+    const char *env = getenv("CACHE_CONFIG");
+    if (!(env && cache_config_read_file(c, env))
+        && !cache_config_read_file(c, "cache.conf")
+        && !cache_config_read_file(c, "../cache_probe/cache.conf"))
+        snprintf(c->source, sizeof(c->source), "nominal (sysconf)");
+
+    // Fill in whatever is still missing
+    if (c->l1_bytes <= 0) c->l1_bytes = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    if (c->l2_bytes <= 0) c->l2_bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (c->l3_bytes <= 0) c->l3_bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (c->l1_bytes <= 0) c->l1_bytes = 32 * 1024;
+    if (c->l2_bytes <= 0) c->l2_bytes = 256 * 1024;
+    if (c->l3_bytes <= 0) c->l3_bytes = 8 * 1024 * 1024;
+
+    // A hand-edited or truncated cache.conf can still give nonsense like
+    // l2_bytes=1; never go below one cache line so block sizes stay >= 1
+    long line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    if (line <= 0) line = 64;
+    if (c->l1_bytes < line) c->l1_bytes = line;
+    if (c->l2_bytes < line) c->l2_bytes = line;
+    if (c->l3_bytes < line) c->l3_bytes = line;
+}
+
+#endif
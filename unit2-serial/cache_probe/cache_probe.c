@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Measure the memory hierarchy instead of trusting `getconf`.
+ *
+ * For working sets from 4 KB up to max_mb, we measure:
+ *
+ *   Latency:   follow a chain of pointers laid out in random order, one per
+ *              cache line. Each load needs the previous one's result, and
+ *              the random order defeats the prefetcher, so the time per
+ *              step is the real load-to-use latency of wherever the data
+ *              lives.
+ *   Bandwidth: sum the working set over and over with 8 independent
+ *              accumulators (see ../pipelining), so the loads, not the
+ *              adds, are the bottleneck.
+ *
+ * Latency stays flat while the working set fits in a level and jumps when
+ * it doesn't. The last size before each jump is that level's effective
+ * capacity, which is often less than the nominal size (the cache is
+ * shared with code, page tables, and other cores).
+ *
+ * The results go to cache.conf (see cache_config.h), which lu_demo and
+ * pipeline_demo read to pick their block sizes.
+ *
+ * Usage: cache_probe [max_mb] [output_file]
+ */
+
+#define MIN_BYTES 4096L
+#define CHASE_STEPS (1L << 22)
+#define STREAM_BYTES (1L << 30)   // read at least this much per bandwidth point
+#define JUMP 1.8                  // latency this many times the level's base = next level
+#define RAMP 1.15                 // still climbing to the next level's plateau
+#define MAX_LEVELS 3
+
+double get_time(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+size_t line_size(void) {
+    long size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    return size > 0 ? size : 64;
+}
+
+// Nanoseconds per dependent load over a working set of `bytes`
+double chase_latency(char *buf, size_t bytes, size_t line) {
+    size_t lines = bytes / line;
+    size_t *order = malloc(lines * sizeof(size_t));
+    for (size_t i = 0; i < lines; i++)
+        order[i] = i;
+
+    // Random cyclic order (Fisher-Yates shuffle)
+    uint64_t rng = 88172645463325252ULL;
+    for (size_t i = lines - 1; i > 0; i--) {
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+        size_t j = rng % (i + 1);
+        size_t tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+    }
+    for (size_t i = 0; i < lines; i++)
+        *(void **)(buf + order[i] * line) = buf + order[(i + 1) % lines] * line;
+    free(order);
+
+    // Once around to warm up, then time it
+    void **p = (void **)buf;
+    for (size_t i = 0; i < lines; i++)
+        p = *p;
+
+    double start = get_time();
+    for (long i = 0; i < CHASE_STEPS; i++)
+        p = *p;
+    double elapsed = get_time() - start;
+
+    // Use p so the loop can't be removed
+    if (p == NULL)
+        printf("impossible\n");
+    return elapsed / CHASE_STEPS * 1e9;
+}
+
+// GB/s reading a working set of `bytes`
+double stream_bandwidth(double *a, size_t bytes) {
+    size_t n = bytes / sizeof(double);
+    long reps = STREAM_BYTES / bytes + 1;
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0, s5 = 0, s6 = 0, s7 = 0;
+
+    double start = get_time();
+    for (long r = 0; r < reps; r++) {
+        for (size_t i = 0; i + 7 < n; i += 8) {
+            s0 += a[i];     s1 += a[i + 1]; s2 += a[i + 2]; s3 += a[i + 3];
+            s4 += a[i + 4]; s5 += a[i + 5]; s6 += a[i + 6]; s7 += a[i + 7];
+        }
+    }
+    double elapsed = get_time() - start;
+
+    if (s0 + s1 + s2 + s3 + s4 + s5 + s6 + s7 == -1.0)
+        printf("impossible\n");
+    return (double)reps * bytes / elapsed / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    long max_mb = 512;
+    const char *output = "cache.conf";
+
+    if (argc > 1) {
+        max_mb = atol(argv[1]);
+    }
+    if (argc > 2) {
+        output = argv[2];
+    }
+    if (max_mb < 1) {
+        printf("Usage: %s [max_mb >= 1] [output_file]\n", argv[0]);
+        return 1;
+    }
+
+    // Sizes 4K, 6K, 8K, 12K, 16K, ... (powers of two and halfway between)
+    long sizes[64];
+    int num_sizes = 0;
+    for (long s = MIN_BYTES; s <= max_mb * 1024 * 1024 && num_sizes < 63; s *= 2) {
+        sizes[num_sizes++] = s;
+        if (s * 3 / 2 <= max_mb * 1024 * 1024)
+            sizes[num_sizes++] = s * 3 / 2;
+    }
+
+    size_t line = line_size();
+    char *buf = aligned_alloc(4096, sizes[num_sizes - 1]);
+    if (!buf) {
+        printf("Memory allocation failed\n");
+        return 1;
+    }
+
+    printf("Cache probe: %zu-byte lines, working sets up to %ld MB\n\n", line, max_mb);
+    printf("%12s %14s %16s\n", "Working set", "Latency (ns)", "Bandwidth (GB/s)");
+
+    double latency[64], bandwidth[64];
+    for (int i = 0; i < num_sizes; i++) {
+        latency[i] = chase_latency(buf, sizes[i], line);
+        // The chase left pointers in the buffer. Read as doubles, those are
+        // denormals, and adding denormals can take a slow microcode path
+        // that would show up as low bandwidth - so put ordinary numbers back.
+        for (long j = 0; j < sizes[i] / (long)sizeof(double); j++)
+            ((double *)buf)[j] = 1.0;
+        bandwidth[i] = stream_bandwidth((double *)buf, sizes[i]);
+        if (sizes[i] % (1024 * 1024) != 0)
+            printf("%10ld K %14.2f %16.1f\n", sizes[i] / 1024, latency[i], bandwidth[i]);
+        else
+            printf("%10ld M %14.2f %16.1f\n", sizes[i] / (1024 * 1024), latency[i], bandwidth[i]);
+    }
+
+    // Find the jumps. A level ends at the last size within JUMP x its base
+    // latency; the next level's base is where the climb levels off again.
+    long capacity[MAX_LEVELS] = { 0 };
+    int first[MAX_LEVELS + 1] = { 0 };   // index of each level's first point
+    int levels = 0;
+    double base = latency[0];
+    for (int i = 1; i < num_sizes && levels < MAX_LEVELS; i++) {
+        if (latency[i] > JUMP * base) {
+            capacity[levels++] = sizes[i - 1];
+            while (i + 1 < num_sizes && latency[i + 1] > RAMP * latency[i])
+                i++;
+            first[levels] = i;
+            base = latency[i];
+        }
+    }
+
+    // The last level found has no measured end: it's DRAM if we found
+    // three caches, otherwise the sweep stopped too soon to see the rest
+    const char *names[] = { "L1", "L2", "L3", "DRAM" };
+    printf("\nEffective levels:\n");
+    for (int l = 0; l <= levels; l++) {
+        int i = first[l];
+        if (l < levels)
+            printf("  %-4s %8ld KB  %6.2f ns  %6.1f GB/s\n", names[l], capacity[l] / 1024,
+                   latency[i], bandwidth[i]);
+        else
+            printf("  %-4s %11s  %6.2f ns  %6.1f GB/s%s\n", names[l], "-", latency[i],
+                   bandwidth[i], l < MAX_LEVELS ? "  (no end found: try a bigger max_mb)" : "");
+    }
+    printf("Nominal (sysconf): L1 %ld KB, L2 %ld KB, L3 %ld KB\n",
+           sysconf(_SC_LEVEL1_DCACHE_SIZE) / 1024, sysconf(_SC_LEVEL2_CACHE_SIZE) / 1024,
+           sysconf(_SC_LEVEL3_CACHE_SIZE) / 1024);
+
+    FILE *f = fopen(output, "w");
+    if (!f) {
+        perror(output);
+        return 1;
+    }
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host));
+    fprintf(f, "# Effective cache sizes measured by cache_probe on %s\n", host);
+    fprintf(f, "# A level missing here wasn't found; readers fall back to sysconf\n");
+    for (int l = 0; l < levels; l++)
+        fprintf(f, "l%d_bytes=%ld\n", l + 1, capacity[l]);
+    fprintf(f, "# Latency (ns) and read bandwidth (GB/s) on each plateau, for reference\n");
+    for (int l = 0; l <= levels; l++)
+        fprintf(f, "# %s: %.2f ns, %.1f GB/s\n", names[l], latency[first[l]], bandwidth[first[l]]);
+    fclose(f);
+    printf("\nWrote %s\n", output);
+
+    free(buf);
+    return 0;
+}
@@ -2,6 +2,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "cache_config.h"
 
 // Serial element-wise LU factorization without pivoting (element-wise)
 // This is textbook Gaussian Elimination via row reductions.
@@ -32,6 +36,71 @@ void lu_factorize_serial(double *A, int n) {
     }
 }
 
+// Blocked ("tiled") LU factorization without pivoting
+// Same result as lu_factorize_serial (up to rounding), same column-major layout.
+//
+// The unblocked version sweeps the whole trailing matrix once per diagonal
+// element: n passes over up to n^2 doubles, which stops fitting in cache
+// around n = 300. Here we eliminate nb columns at a time:
+//
+//   1. Factor the panel A[k:n, k:k+nb] (tall and skinny: stays in cache)
+//   2. Update the block row to the right:  U12 = L11^-1 * A12
+//   3. Update the trailing matrix:         A22 -= L21 * U12
+//
+// Step 3 is almost all the work, and we do it one nb x nb tile of A22 at
+// a time, so the L21 tile it reads stays in cache while we sweep across.
+// All inner loops run down columns (unit stride).
+void lu_factorize_blocked(double *A, int n, int nb) {
+    for (int k = 0; k < n; k += nb) {
+        int kb = (n - k < nb) ? n - k : nb;   // this panel's width
+
+        // 1. Unblocked elimination of the panel's columns, rows k..n-1
+        for (int d = k; d < k + kb; ++d) {
+            for (int r = d + 1; r < n; ++r)
+                A[r + d * n] /= A[d + d * n];
+            for (int c = d + 1; c < k + kb; ++c) {
+                double u = A[d + c * n];
+                for (int r = d + 1; r < n; ++r)
+                    A[r + c * n] -= A[r + d * n] * u;
+            }
+        }
+
+        // 2. Forward substitution with the panel's unit lower triangle
+        for (int c = k + kb; c < n; ++c) {
+            for (int d = k; d < k + kb; ++d) {
+                double u = A[d + c * n];
+                for (int r = d + 1; r < k + kb; ++r)
+                    A[r + c * n] -= A[r + d * n] * u;
+            }
+        }
+
+        // 3. Trailing update, tile by tile
+        for (int c0 = k + kb; c0 < n; c0 += nb) {
+            int c1 = (c0 + nb < n) ? c0 + nb : n;
+            for (int r0 = k + kb; r0 < n; r0 += nb) {
+                int r1 = (r0 + nb < n) ? r0 + nb : n;
+                for (int c = c0; c < c1; ++c) {
+                    for (int d = k; d < k + kb; ++d) {
+                        double u = A[d + c * n];
+                        for (int r = r0; r < r1; ++r)
+                            A[r + c * n] -= A[r + d * n] * u;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Block size for lu_factorize_blocked: the biggest nb (a multiple of 8)
+// where three nb x nb tiles of doubles fit in the effective L2 cache
+int choose_lu_block_size(const cache_config *cache, int n) {
+    int nb = (int)sqrt(cache->l2_bytes / (3.0 * sizeof(double)));
+    nb -= nb % 8;
+    if (nb < 8) nb = 8;
+    if (nb > n) nb = n;
+    return nb;
+}
+
 // Solve linear system Ax = b using LU factorization (serial baseline)
 // This is the textbook two-phase triangular solve after LU decomposition.
 //
@@ -40,14 +109,14 @@ void lu_factorize_serial(double *A, int n) {
 //   - U on and above diagonal
 // b is the right-hand side vector
 // x is the solution vector (output)
-void solve_lu_system(const double *LU, const double *b, double *x, int n) {
+// y is scratch space for n doubles
+void solve_lu_system_ws(const double *LU, const double *b, double *x, int n, double *y) {
 
     // Remember, column-major: LU[r,c] -> LU[r + c*n]
     // ie, moving down a column by one (r++) is unit stride in memory
 
     // Phase 1: Forward substitution to solve Ly = b
     // Since L has ones on the diagonal, we don't need to store or divide by them
-    double *y = malloc(n * sizeof(double));
     for (int i = 0; i < n; ++i) {
         y[i] = b[i];
 
@@ -70,7 +139,12 @@ void solve_lu_system(const double *LU, const double *b, double *x, int n) {
         // Divide by diagonal element of U
         x[i] /= LU[i + i * n];
     }
+}
 
+// Same, allocating its own scratch space
+void solve_lu_system(const double *LU, const double *b, double *x, int n) {
+    double *y = malloc(n * sizeof(double));
+    solve_lu_system_ws(LU, b, x, n, y);
     free(y);
 }
 
@@ -119,7 +193,457 @@ void print_vector(const double *v, int n) {
     }
 }
 
-int main() {
+
+/* ---------- Throughput mode: many independent systems on a thread pool ---------- */
+
+// A bump allocator: one big block per thread, handed out front to back
+// and reset between jobs. After the first job, no more heap calls.
+typedef struct {
+    char *base;
+    size_t capacity;
+    size_t used;
+} arena;
+
+void *arena_alloc(arena *a, size_t bytes) {
+    bytes = (bytes + 63) & ~(size_t)63;   // keep every array cache-line aligned
+    if (a->used + bytes > a->capacity)
+        return NULL;
+    void *p = a->base + a->used;
+    a->used += bytes;
+    return p;
+}
+
+void arena_reset(arena *a) {
+    a->used = 0;
+}
+
+// The job queue is just a counter: each worker grabs the next job number
+typedef struct {
+    int n;
+    int num_systems;
+    int use_arena;
+    atomic_int next_job;
+} job_queue;
+
+// Each worker updates its own counters all the time. Aligning them to a
+// cache line gives every worker a line of its own, so the workers don't
+// slow each other down with false sharing (see unit4-openmp/falsesharing).
+typedef struct {
+    job_queue *queue;
+    long heap_calls;          // malloc + free
+    double alloc_seconds;     // time spent inside them
+    double max_residual;
+} __attribute__((aligned(64))) worker_stats;
+
+double wall_time(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+void *timed_malloc(worker_stats *w, size_t bytes) {
+    double start = wall_time();
+    void *p = malloc(bytes);
+    w->alloc_seconds += wall_time() - start;
+    w->heap_calls++;
+    return p;
+}
+
+void timed_free(worker_stats *w, void *p) {
+    double start = wall_time();
+    free(p);
+    w->alloc_seconds += wall_time() - start;
+    w->heap_calls++;
+}
+
+// System number `job`: init_matrix's matrix with a job-dependent diagonal
+double job_entry(int i, int j, int n, int job) {
+    if (i == j)
+        return n + 1.0 + (job % 100) * 0.01;
+    return 1.0 / (1.0 + abs(i - j));
+}
+
+void *throughput_worker(void *arg) {
+    worker_stats *w = arg;
+    job_queue *q = w->queue;
+    int n = q->n;
+    size_t matrix_bytes = (size_t)n * n * sizeof(double);
+    size_t vector_bytes = n * sizeof(double);
+
+    arena ws = { NULL, 0, 0 };
+    if (q->use_arena) {
+        ws.capacity = matrix_bytes + 3 * vector_bytes + 4 * 64;
+        ws.base = timed_malloc(w, ws.capacity);
+    }
+
+    for (;;) {
+        int job = atomic_fetch_add(&q->next_job, 1);
+        if (job >= q->num_systems)
+            break;
+
+        double *LU, *b, *x, *y;
+        if (q->use_arena) {
+            arena_reset(&ws);
+            LU = arena_alloc(&ws, matrix_bytes);
+            b = arena_alloc(&ws, vector_bytes);
+            x = arena_alloc(&ws, vector_bytes);
+            y = arena_alloc(&ws, vector_bytes);
+        } else {
+            // What solving one system with the functions above costs
+            LU = timed_malloc(w, matrix_bytes);
+            b = timed_malloc(w, vector_bytes);
+            x = timed_malloc(w, vector_bytes);
+            y = timed_malloc(w, vector_bytes);
+        }
+
+        for (int j = 0; j < n; ++j)
+            for (int i = 0; i < n; ++i)
+                LU[i + j * n] = job_entry(i, j, n, job);
+        init_vector(b, n);
+
+        lu_factorize_serial(LU, n);
+        solve_lu_system_ws(LU, b, x, n, y);
+
+        // Residual max |Ax - b|, rebuilding A from the formula
+        for (int i = 0; i < n; ++i) {
+            double r = -b[i];
+            for (int j = 0; j < n; ++j)
+                r += job_entry(i, j, n, job) * x[j];
+            if (fabs(r) > w->max_residual)
+                w->max_residual = fabs(r);
+        }
+
+        if (!q->use_arena) {
+            timed_free(w, LU);
+            timed_free(w, b);
+            timed_free(w, x);
+            timed_free(w, y);
+        }
+    }
+
+    if (q->use_arena)
+        timed_free(w, ws.base);
+    return NULL;
+}
+
+void run_throughput(int num_threads, int num_systems, int n) {
+    printf("Throughput mode: %d systems of size n=%d on %d threads\n\n",
+           num_systems, n, num_threads);
+    printf("%-10s %12s %12s %16s %14s\n", "Scratch", "Systems/s", "Heap calls",
+           "Alloc time (s)", "Max residual");
+
+    for (int use_arena = 0; use_arena <= 1; ++use_arena) {
+        job_queue q = { n, num_systems, use_arena, 0 };
+        pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+        worker_stats *stats = aligned_alloc(64, num_threads * sizeof(worker_stats));
+        memset(stats, 0, num_threads * sizeof(worker_stats));
+
+        double start = wall_time();
+        for (int t = 0; t < num_threads; ++t) {
+            stats[t].queue = &q;
+            pthread_create(&threads[t], NULL, throughput_worker, &stats[t]);
+        }
+        for (int t = 0; t < num_threads; ++t)
+            pthread_join(threads[t], NULL);
+        double elapsed = wall_time() - start;
+
+        long heap_calls = 0;
+        double alloc_seconds = 0.0, max_residual = 0.0;
+        for (int t = 0; t < num_threads; ++t) {
+            heap_calls += stats[t].heap_calls;
+            alloc_seconds += stats[t].alloc_seconds;
+            if (stats[t].max_residual > max_residual)
+                max_residual = stats[t].max_residual;
+        }
+        printf("%-10s %12.1f %12ld %16.6f %14.2e\n", use_arena ? "arena" : "per-call",
+               num_systems / elapsed, heap_calls, alloc_seconds, max_residual);
+
+        free(threads);
+        free(stats);
+    }
+    printf("\n(Alloc time is summed over threads. Arena heap calls are one malloc\n"
+           " and one free per thread, outside the steady state.)\n");
+}
+
+/* ---------- Low-rank updates: Sherman-Morrison-Woodbury on the solves ---------- */
+
+// When A changes by a rank-k term, A' = A + U * V^T (U and V are n x k),
+// refactoring costs O(n^3). The Woodbury identity reuses A's factors:
+//
+//     A'^-1 b = y - Z * C^-1 * (V^T y)
+//
+// where y = A^-1 b, Z = A^-1 U, and C = I + V^T Z is only k x k.
+// Applying an update costs k triangular solves (O(k n^2)) to get Z, and
+// each solve afterwards costs one more triangular solve plus O(n k).
+//
+// Updates pile up: after several, U and V hold all of them side by side.
+// Once they reach max_rank columns, or a solve's residual exceeds the
+// tolerance (rounding error grows with each update), we refactor A' from
+// scratch and start over with no updates.
+//
+// Like the rest of this file there's no pivoting, in the factors or in C,
+// so this is for well-behaved (e.g. diagonally dominant) matrices.
+typedef struct {
+    int n, nb;              // size, and block size for refactoring
+    double *A;              // the current matrix, with all updates applied
+    double *LU;             // factors of the matrix at the last refactorization
+    double A_norm;          // max row sum of |A|, for the error estimate
+
+    int rank, max_rank;     // update columns held so far, and the limit
+    double *U, *V, *Z;      // n x max_rank each; Z = (refactored A)^-1 U
+    double *C;              // max_rank x max_rank: I + V^T Z
+    double *C_lu;           // rank x rank factors of C
+
+    double *y, *r, *t;      // scratch: n, n, max_rank
+    double tolerance;       // refactor when relative residual exceeds this
+    double last_error;      // relative residual of the last solve
+    int refactorizations;
+} lu_updatable;
+
+double matrix_norm_inf(const double *A, int n) {
+    double norm = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double row = 0.0;
+        for (int j = 0; j < n; ++j)
+            row += fabs(A[i + j * n]);
+        if (row > norm)
+            norm = row;
+    }
+    return norm;
+}
+
+// Factor the current A and forget the updates
+void lu_update_refactor(lu_updatable *f) {
+    int n = f->n;
+    memcpy(f->LU, f->A, (size_t)n * n * sizeof(double));
+    lu_factorize_blocked(f->LU, n, f->nb);
+    f->rank = 0;
+    f->refactorizations++;
+}
+
+void lu_update_init(lu_updatable *f, const double *A, int n, int nb,
+                    int max_rank, double tolerance) {
+    f->n = n;
+    f->nb = nb;
+    f->max_rank = max_rank;
+    f->tolerance = tolerance;
+    f->A = malloc((size_t)n * n * sizeof(double));
+    f->LU = malloc((size_t)n * n * sizeof(double));
+    f->U = malloc((size_t)n * max_rank * sizeof(double));
+    f->V = malloc((size_t)n * max_rank * sizeof(double));
+    f->Z = malloc((size_t)n * max_rank * sizeof(double));
+    f->C = malloc((size_t)max_rank * max_rank * sizeof(double));
+    f->C_lu = malloc((size_t)max_rank * max_rank * sizeof(double));
+    f->y = malloc(n * sizeof(double));
+    f->r = malloc(n * sizeof(double));
+    f->t = malloc(max_rank * sizeof(double));
+
+    memcpy(f->A, A, (size_t)n * n * sizeof(double));
+    f->A_norm = matrix_norm_inf(A, n);
+    f->refactorizations = -1;   // the first one doesn't count
+    f->last_error = 0.0;
+    lu_update_refactor(f);
+}
+
+void lu_update_free(lu_updatable *f) {
+    free(f->A); free(f->LU);
+    free(f->U); free(f->V); free(f->Z);
+    free(f->C); free(f->C_lu);
+    free(f->y); free(f->r); free(f->t);
+}
+
+// A += U * V^T, with U and V n x k (column-major)
+void lu_update_rank_k(lu_updatable *f, const double *U, const double *V, int k) {
+    int n = f->n;
+
+    // The matrix itself, for residuals and the next refactorization
+    for (int j = 0; j < n; ++j)
+        for (int p = 0; p < k; ++p) {
+            double v = V[j + p * n];
+            for (int i = 0; i < n; ++i)
+                f->A[i + j * n] += U[i + p * n] * v;
+        }
+    f->A_norm = matrix_norm_inf(f->A, n);
+
+    // No room for more columns: start over from the updated matrix
+    if (f->rank + k > f->max_rank) {
+        lu_update_refactor(f);
+        return;
+    }
+
+    // Append the new columns, and Z = A^-1 U for them
+    int old = f->rank;
+    memcpy(f->U + (size_t)old * n, U, (size_t)n * k * sizeof(double));
+    memcpy(f->V + (size_t)old * n, V, (size_t)n * k * sizeof(double));
+    for (int p = old; p < old + k; ++p)
+        solve_lu_system_ws(f->LU, f->U + (size_t)p * n, f->Z + (size_t)p * n, n, f->y);
+    f->rank = old + k;
+
+    // Fill in the new rows and columns of C = I + V^T Z
+    int m = f->max_rank;
+    for (int j = 0; j < f->rank; ++j)
+        for (int i = 0; i < f->rank; ++i) {
+            if (i < old && j < old)
+                continue;
+            double sum = (i == j) ? 1.0 : 0.0;
+            for (int l = 0; l < n; ++l)
+                sum += f->V[l + (size_t)i * n] * f->Z[l + (size_t)j * n];
+            f->C[i + j * m] = sum;
+        }
+
+    // Factor the rank x rank C (cheap while rank << n)
+    for (int j = 0; j < f->rank; ++j)
+        for (int i = 0; i < f->rank; ++i)
+            f->C_lu[i + j * f->rank] = f->C[i + j * m];
+    lu_factorize_serial(f->C_lu, f->rank);
+}
+
+// Solve A x = b with the current (updated) A
+void lu_update_solve(lu_updatable *f, const double *b, double *x) {
+    int n = f->n;
+
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        // y = A^-1 b with the old factors; Woodbury correction if there are updates
+        solve_lu_system_ws(f->LU, b, x, n, f->y);
+        if (f->rank > 0) {
+            int k = f->rank;
+            for (int p = 0; p < k; ++p) {
+                double sum = 0.0;
+                for (int i = 0; i < n; ++i)
+                    sum += f->V[i + (size_t)p * n] * x[i];
+                f->r[p] = sum;                       // V^T y
+            }
+            solve_lu_system_ws(f->C_lu, f->r, f->t, k, f->y);   // s = C^-1 V^T y
+            for (int p = 0; p < k; ++p)
+                for (int i = 0; i < n; ++i)
+                    x[i] -= f->Z[i + (size_t)p * n] * f->t[p];
+        }
+
+        // Relative residual |A x - b| / (|A| |x| + |b|), in the infinity norm
+        double r_max = 0.0, x_max = 0.0, b_max = 0.0;
+        for (int i = 0; i < n; ++i)
+            f->r[i] = -b[i];
+        for (int j = 0; j < n; ++j)
+            for (int i = 0; i < n; ++i)
+                f->r[i] += f->A[i + j * n] * x[j];
+        for (int i = 0; i < n; ++i) {
+            if (fabs(f->r[i]) > r_max) r_max = fabs(f->r[i]);
+            if (fabs(x[i]) > x_max) x_max = fabs(x[i]);
+            if (fabs(b[i]) > b_max) b_max = fabs(b[i]);
+        }
+        f->last_error = r_max / (f->A_norm * x_max + b_max);
+
+        if (f->last_error <= f->tolerance || f->rank == 0)
+            return;
+        lu_update_refactor(f);   // too much drift: refactor and solve again
+    }
+}
+
+// Fill an n x k matrix with random entries in [-1, 1]
+void random_columns(double *M, int n, int k, unsigned *seed) {
+    for (long i = 0; i < (long)n * k; ++i)
+        M[i] = 2.0 * rand_r(seed) / RAND_MAX - 1.0;
+}
+
+void run_update_benchmark(int n, int steps) {
+    cache_config cache;
+    cache_config_load(&cache);
+    int nb = choose_lu_block_size(&cache, n);
+    int max_rank = n / 4;
+    double tolerance = 1e-12;
+    const int ks[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+    const int num_ks = sizeof(ks) / sizeof(ks[0]);
+
+    printf("Rank-k updates: n=%d, %d updates in a row for each k\n", n, steps);
+    printf("Refactor = blocked LU (block size %d) + solve; update = Woodbury\n", nb);
+    printf("Updates held until rank %d or relative residual %.0e\n\n", max_rank, tolerance);
+    printf("%6s %14s %14s %9s %10s %12s\n", "k", "Refactor (ms)", "Update (ms)",
+           "Speedup", "Refactors", "Max error");
+
+    double *A0 = malloc((size_t)n * n * sizeof(double));
+    double *A = malloc((size_t)n * n * sizeof(double));
+    double *U = malloc((size_t)n * ks[num_ks - 1] * sizeof(double));
+    double *V = malloc((size_t)n * ks[num_ks - 1] * sizeof(double));
+    double *b = malloc(n * sizeof(double));
+    double *x = malloc(n * sizeof(double));
+    double *y = malloc(n * sizeof(double));
+    init_matrix(A0, n);
+    init_vector(b, n);
+
+    for (int ki = 0; ki < num_ks; ++ki) {
+        int k = ks[ki];
+        if (k > n)
+            break;
+
+        // Refactor-and-solve, on the same sequence of updates
+        unsigned seed = 1234;
+        memcpy(A, A0, (size_t)n * n * sizeof(double));
+        double *LU = malloc((size_t)n * n * sizeof(double));
+        double refactor_time = 0.0;
+        for (int s = 0; s < steps; ++s) {
+            random_columns(U, n, k, &seed);
+            random_columns(V, n, k, &seed);
+            double start = wall_time();
+            for (int j = 0; j < n; ++j)
+                for (int p = 0; p < k; ++p)
+                    for (int i = 0; i < n; ++i)
+                        A[i + j * n] += U[i + p * n] * V[j + p * n];
+            memcpy(LU, A, (size_t)n * n * sizeof(double));
+            lu_factorize_blocked(LU, n, nb);
+            solve_lu_system_ws(LU, b, x, n, y);
+            refactor_time += wall_time() - start;
+        }
+        free(LU);
+
+        // Update-and-solve
+        seed = 1234;
+        lu_updatable f;
+        lu_update_init(&f, A0, n, nb, max_rank, tolerance);
+        double update_time = 0.0, max_error = 0.0;
+        for (int s = 0; s < steps; ++s) {
+            random_columns(U, n, k, &seed);
+            random_columns(V, n, k, &seed);
+            double start = wall_time();
+            lu_update_rank_k(&f, U, V, k);
+            lu_update_solve(&f, b, x);
+            update_time += wall_time() - start;
+            if (f.last_error > max_error)
+                max_error = f.last_error;
+        }
+
+        printf("%6d %14.3f %14.3f %8.1fx %10d %12.1e\n", k, 1e3 * refactor_time / steps,
+               1e3 * update_time / steps, refactor_time / update_time, f.refactorizations,
+               max_error);
+        lu_update_free(&f);
+    }
+
+    free(A0); free(A); free(U); free(V);
+    free(b); free(x); free(y);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "throughput") == 0) {
+        int num_threads = argc > 2 ? atoi(argv[2]) : 4;
+        int num_systems = argc > 3 ? atoi(argv[3]) : 2000;
+        int size = argc > 4 ? atoi(argv[4]) : 100;
+        if (num_threads < 1 || num_systems < 1 || size < 1) {
+            printf("Usage: %s throughput [threads >= 1] [systems >= 1] [n >= 1]\n", argv[0]);
+            return 1;
+        }
+        run_throughput(num_threads, num_systems, size);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "update") == 0) {
+        int size = argc > 2 ? atoi(argv[2]) : 500;
+        int steps = argc > 3 ? atoi(argv[3]) : 10;
+        if (size < 1 || steps < 1) {
+            printf("Usage: %s update [n >= 1] [steps >= 1]\n", argv[0]);
+            return 1;
+        }
+        run_update_benchmark(size, steps);
+        return 0;
+    }
+
     const int n = 128;
 
     printf("LU Factorization and Solve Demo (n=%d)\n", n);
@@ -187,6 +711,45 @@ int main() {
     double avg_time = ((double)(end - start)) / CLOCKS_PER_SEC / 100.0;
     printf("Average time per iteration: %.6f seconds\n", avg_time);
 
+    // Blocked factorization, with the block size picked from the measured
+    // cache sizes (run ../cache_probe first to write cache.conf)
+    cache_config cache;
+    cache_config_load(&cache);
+    const int big_n = 1024;
+    int nb = choose_lu_block_size(&cache, big_n);
+
+    printf("\nBlocked vs. unblocked LU at n=%d\n", big_n);
+    printf("Cache sizes: L1 %ld KB, L2 %ld KB, L3 %ld KB, %s\n", cache.l1_bytes / 1024,
+           cache.l2_bytes / 1024, cache.l3_bytes / 1024, cache.source);
+    printf("Block size: %d\n", nb);
+
+    double *A1 = malloc((size_t)big_n * big_n * sizeof(double));
+    double *A2 = malloc((size_t)big_n * big_n * sizeof(double));
+    if (!A1 || !A2) {
+        printf("Memory allocation failed!\n");
+        return 1;
+    }
+    init_matrix(A1, big_n);
+    init_matrix(A2, big_n);
+
+    start = clock();
+    lu_factorize_serial(A1, big_n);
+    mid = clock();
+    lu_factorize_blocked(A2, big_n, nb);
+    end = clock();
+
+    double max_diff = 0.0;
+    for (long i = 0; i < (long)big_n * big_n; ++i) {
+        if (fabs(A1[i] - A2[i]) > max_diff)
+            max_diff = fabs(A1[i] - A2[i]);
+    }
+    printf("Unblocked: %.4f seconds\n", ((double)(mid - start)) / CLOCKS_PER_SEC);
+    printf("Blocked:   %.4f seconds\n", ((double)(end - mid)) / CLOCKS_PER_SEC);
+    printf("Largest difference in the factors: %.2e\n", max_diff);
+
+    free(A1);
+    free(A2);
+
     // Cleanup
     free(A);
     free(b);
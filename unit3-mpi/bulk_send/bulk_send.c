@@ -8,6 +8,15 @@
 /******
  * Program to illustrate that sending one value, 1000 times
  * is much slower than sending 1000 values, 1 time.
+ *
+ * The "put-loop" and "put-bulk" modes do the same transfers one-sided:
+ * process 0 writes straight into process 1's memory with MPI_Put, and
+ * process 1 never posts a matching receive.
+ *
+ * The "shm" mode skips the transfer altogether when both processes are on
+ * the same node: process 0 fills an MPI_Win_allocate_shared segment, and
+ * after a barrier process 1 reads the array in place. Across nodes it
+ * falls back to the single MPI_Send.
  ******/
 
 const int PROBLEM_SIZE = 1000;
@@ -36,6 +45,44 @@ void transfer_array_batch(double* data_array, int my_rank) {
         MPI_Recv(data_array, PROBLEM_SIZE, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 }
 
+// One-sided: process 1 exposes data_array as an RMA window, and process 0
+// MPI_Puts into it. The fences are collective, but only process 0 moves data.
+void put_array_loop(double* data_array, int my_rank, MPI_Win win) {
+    MPI_Win_fence(MPI_MODE_NOPRECEDE, win);
+    if (my_rank == 0) {
+        for (int i = 0; i < PROBLEM_SIZE; ++i)
+            MPI_Put(&data_array[i], 1, MPI_DOUBLE, 1, i, 1, MPI_DOUBLE, win);
+    }
+    MPI_Win_fence(MPI_MODE_NOSUCCEED, win);
+}
+
+void put_array_batch(double* data_array, int my_rank, MPI_Win win) {
+    MPI_Win_fence(MPI_MODE_NOPRECEDE, win);
+    if (my_rank == 0)
+        MPI_Put(data_array, PROBLEM_SIZE, MPI_DOUBLE, 1, 0, PROBLEM_SIZE, MPI_DOUBLE, win);
+    MPI_Win_fence(MPI_MODE_NOSUCCEED, win);
+}
+
+// Which rank of node_comm is this world rank? (MPI_UNDEFINED if another node)
+int node_rank_of(MPI_Comm node_comm, int world_rank) {
+    MPI_Group world_group, node_group;
+    int node_rank;
+    MPI_Comm_group(MPI_COMM_WORLD, &world_group);
+    MPI_Comm_group(node_comm, &node_group);
+    MPI_Group_translate_ranks(world_group, 1, &world_rank, node_group, &node_rank);
+    MPI_Group_free(&world_group);
+    MPI_Group_free(&node_group);
+    return node_rank;
+}
+
+// Shared memory: nothing to copy. Process 0's stores only need to be
+// visible to process 1 before it starts reading.
+void share_array(MPI_Win win) {
+    MPI_Win_sync(win);
+    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Win_sync(win);
+}
+
 
 int main(int argc, char** argv) {
 
@@ -47,14 +94,50 @@ int main(int argc, char** argv) {
     MPI_Comm_size(MPI_COMM_WORLD, &comm_sz);
     MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
 
+    // Creating a window is collective and not free, so do it before timing
+    int one_sided = strncmp("put", argv[1], 3) == 0;
+    MPI_Win win;
+    if (one_sided)
+        MPI_Win_create(data_array, PROBLEM_SIZE * sizeof(double), sizeof(double),
+                       MPI_INFO_NULL, MPI_COMM_WORLD, &win);
+
+    // Shared-memory mode only works if processes 0 and 1 share a node
+    int shm_requested = strcmp("shm", argv[1]) == 0;
+    int shared = 0;
+    double* data = data_array;
+    MPI_Comm node_comm;
+    if (shm_requested) {
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+        shared = node_rank_of(node_comm, 0) != MPI_UNDEFINED &&
+                 node_rank_of(node_comm, 1) != MPI_UNDEFINED;
+        MPI_Bcast(&shared, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+        if (shared) {
+            // Only process 0 needs memory; everyone else points at its segment
+            MPI_Aint seg_size = my_rank == 0 ? PROBLEM_SIZE * sizeof(double) : 0;
+            int disp_unit;
+            MPI_Win_allocate_shared(seg_size, sizeof(double), MPI_INFO_NULL, node_comm, &data, &win);
+            MPI_Win_shared_query(win, node_rank_of(node_comm, 0), &seg_size, &disp_unit, &data);
+            MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+        } else if (my_rank == 0) {
+            printf("Processes 0 and 1 are on different nodes: falling back to bulk MPI_Send\n");
+        }
+    }
+
     if (my_rank == 0)
-        randomize_array(data_array);
+        randomize_array(data);
 
     struct timeval start_time;
     gettimeofday(&start_time, NULL);
 
     if (strcmp("loop", argv[1]) == 0) {
         transfer_array_loop(data_array, my_rank);
+    } else if (strcmp("put-loop", argv[1]) == 0) {
+        put_array_loop(data_array, my_rank, win);
+    } else if (strcmp("put-bulk", argv[1]) == 0) {
+        put_array_batch(data_array, my_rank, win);
+    } else if (shared) {
+        share_array(win);
     } else {
         transfer_array_batch(data_array, my_rank);
     }
@@ -66,7 +149,7 @@ int main(int argc, char** argv) {
     // play reduction games
     double total = 0;
     for (int i = 0; i < PROBLEM_SIZE; ++i)
-        total += data_array[i];
+        total += data[i];
     printf("Process %d: total=%f\n", my_rank, total);
 
     if (my_rank == 0) {
@@ -76,6 +159,15 @@ int main(int argc, char** argv) {
         );
     }
 
+    if (one_sided)
+        MPI_Win_free(&win);
+    if (shared) {
+        MPI_Win_unlock_all(win);
+        MPI_Win_free(&win);
+    }
+    if (shm_requested)
+        MPI_Comm_free(&node_comm);
+
     MPI_Finalize();
     return 0;
 }
@@ -0,0 +1,272 @@
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******
+ * Collective operation benchmark.
+ *
+ * The other unit3-mpi demos time point-to-point messages, but real codes
+ * spend much of their communication time in collectives. This program
+ * times MPI_Bcast, MPI_Reduce, MPI_Allreduce, MPI_Allgather and
+ * MPI_Alltoall over a sweep of message sizes and communicator sizes
+ * (2, 4, 8, ... processes, plus all of them).
+ *
+ * Each iteration is timed on every process, and the slowest process
+ * counts - a collective isn't done until everyone is done. We report the
+ * 50th/90th/99th percentile over iterations, plus the "algorithmic
+ * bandwidth": bytes per process divided by the median time. For allgather
+ * and alltoall that's the message size times the number of processes.
+ *
+ * Finally, MPI_Iallreduce is timed alongside a compute loop, to see how
+ * much of the communication the library can hide behind useful work.
+ *
+ * Usage: collective_bench [bcast|reduce|allreduce|allgather|alltoall|iallreduce]
+ * With no argument, every operation is run.
+ ******/
+
+#define NUM_ITERATIONS 100
+#define NUM_WARMUP 5
+#define MAX_COUNT (1 << 16)   // largest per-process message, in doubles
+
+enum { OP_BCAST, OP_REDUCE, OP_ALLREDUCE, OP_ALLGATHER, OP_ALLTOALL, NUM_OPS };
+const char *OP_NAMES[NUM_OPS] = { "bcast", "reduce", "allreduce", "allgather", "alltoall" };
+
+void run_collective(int op, double *send_buf, double *recv_buf, int count, MPI_Comm comm) {
+    switch (op) {
+    case OP_BCAST:
+        MPI_Bcast(send_buf, count, MPI_DOUBLE, 0, comm);
+        break;
+    case OP_REDUCE:
+        MPI_Reduce(send_buf, recv_buf, count, MPI_DOUBLE, MPI_SUM, 0, comm);
+        break;
+    case OP_ALLREDUCE:
+        MPI_Allreduce(send_buf, recv_buf, count, MPI_DOUBLE, MPI_SUM, comm);
+        break;
+    case OP_ALLGATHER:
+        MPI_Allgather(send_buf, count, MPI_DOUBLE, recv_buf, count, MPI_DOUBLE, comm);
+        break;
+    case OP_ALLTOALL:
+        MPI_Alltoall(send_buf, count, MPI_DOUBLE, recv_buf, count, MPI_DOUBLE, comm);
+        break;
+    }
+}
+
+// Bytes each process sends or receives in one call, for the bandwidth
+// column. Allgather and alltoall move a message per process, not just one.
+double bytes_per_process(int op, int count, int nprocs) {
+    double bytes = count * sizeof(double);
+    if (op == OP_ALLGATHER || op == OP_ALLTOALL)
+        bytes *= nprocs;
+    return bytes;
+}
+
+int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Time NUM_ITERATIONS calls of one collective. On rank 0 of comm, times[]
+// comes back sorted and holds the slowest process's time for each call;
+// on the other ranks it is left unset.
+void time_collective(int op, double *send_buf, double *recv_buf, int count,
+                     MPI_Comm comm, double *times) {
+    double local_times[NUM_ITERATIONS];
+
+    for (int iter = 0; iter < NUM_WARMUP; iter++) {
+        run_collective(op, send_buf, recv_buf, count, comm);
+    }
+
+    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+        MPI_Barrier(comm);
+        double start = MPI_Wtime();
+        run_collective(op, send_buf, recv_buf, count, comm);
+        local_times[iter] = MPI_Wtime() - start;
+    }
+
+    MPI_Reduce(local_times, times, NUM_ITERATIONS, MPI_DOUBLE, MPI_MAX, 0, comm);
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0)
+        qsort(times, NUM_ITERATIONS, sizeof(double), compare_doubles);
+}
+
+double percentile(const double *sorted, double p) {
+    int index = (int)(p / 100.0 * (NUM_ITERATIONS - 1) + 0.5);
+    return sorted[index];
+}
+
+// Stand-in for real computation: a dependent chain the compiler can't remove
+double do_work(long n) {
+    double x = 1.0;
+    for (long i = 0; i < n; i++) {
+        x = x * 1.0000001 + 1e-9;
+    }
+    return x;
+}
+
+// How many do_work() steps fit in the given number of seconds?
+long calibrate_work(double seconds) {
+    long n = 1000;
+    double elapsed = 0.0;
+    while (elapsed < 0.01) {
+        n *= 2;
+        double start = MPI_Wtime();
+        volatile double sink = do_work(n);
+        (void)sink;
+        elapsed = MPI_Wtime() - start;
+    }
+    return (long)(n * seconds / elapsed) + 1;
+}
+
+// Overlap test: start an MPI_Iallreduce, compute for about as long as a
+// blocking MPI_Allreduce takes, then wait. We poke the library with
+// MPI_Test between chunks of work, since many implementations only make
+// progress on a non-blocking collective from inside MPI calls.
+void time_iallreduce(double *send_buf, double *recv_buf, int count, MPI_Comm comm, int rank) {
+    const int NUM_CHUNKS = 10;
+    double times[NUM_ITERATIONS];
+
+    // Pure communication time
+    double t_comm = 0.0;
+    time_collective(OP_ALLREDUCE, send_buf, recv_buf, count, comm, times);
+    if (rank == 0)
+        t_comm = percentile(times, 50);
+    MPI_Bcast(&t_comm, 1, MPI_DOUBLE, 0, comm);
+
+    // Pure compute time, sized to match
+    long chunk = calibrate_work(t_comm / NUM_CHUNKS);
+    double local_times[NUM_ITERATIONS];
+    double sink = 0.0;
+    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+        double start = MPI_Wtime();
+        for (int c = 0; c < NUM_CHUNKS; c++)
+            sink += do_work(chunk);
+        local_times[iter] = MPI_Wtime() - start;
+    }
+    double t_compute = 0.0;
+    MPI_Reduce(local_times, times, NUM_ITERATIONS, MPI_DOUBLE, MPI_MAX, 0, comm);
+    if (rank == 0) {
+        qsort(times, NUM_ITERATIONS, sizeof(double), compare_doubles);
+        t_compute = percentile(times, 50);
+    }
+
+    // Both at once
+    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+        MPI_Request request;
+        int done;
+        MPI_Barrier(comm);
+        double start = MPI_Wtime();
+        MPI_Iallreduce(send_buf, recv_buf, count, MPI_DOUBLE, MPI_SUM, comm, &request);
+        for (int c = 0; c < NUM_CHUNKS; c++) {
+            sink += do_work(chunk);
+            MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+        }
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        local_times[iter] = MPI_Wtime() - start;
+    }
+    MPI_Reduce(local_times, times, NUM_ITERATIONS, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+    if (rank == 0) {
+        qsort(times, NUM_ITERATIONS, sizeof(double), compare_doubles);
+        double t_total = percentile(times, 50);
+        // 100% = communication completely hidden, 0% = no better than serial
+        double overlap = (t_comm + t_compute - t_total) / t_comm;
+        if (overlap < 0.0) overlap = 0.0;
+        if (overlap > 1.0) overlap = 1.0;
+        printf("%-10s %10zu %11.2f %11.2f %11.2f %9.1f%%\n", "iallreduce",
+               count * sizeof(double), t_comm * 1e6, t_compute * 1e6, t_total * 1e6,
+               overlap * 100.0);
+    }
+    if (sink == 42.0)   // keep the compiler from discarding the work
+        printf("!\n");
+}
+
+int main(int argc, char *argv[]) {
+    int rank, size;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    const char *only = argc > 1 ? argv[1] : NULL;
+    int known = !only || strcmp(only, "iallreduce") == 0;
+    for (int op = 0; op < NUM_OPS && !known; op++) {
+        known = strcmp(only, OP_NAMES[op]) == 0;
+    }
+    if (!known) {
+        if (rank == 0)
+            printf("Usage: collective_bench [bcast|reduce|allreduce|allgather|alltoall|iallreduce]\n");
+        MPI_Finalize();
+        return 1;
+    }
+
+    // Room for an alltoall/allgather of MAX_COUNT doubles to every process
+    double *send_buf = malloc((size_t)MAX_COUNT * size * sizeof(double));
+    double *recv_buf = malloc((size_t)MAX_COUNT * size * sizeof(double));
+    for (long i = 0; i < (long)MAX_COUNT * size; i++) {
+        send_buf[i] = rank + i;
+    }
+
+    if (rank == 0) {
+        printf("MPI Collective Benchmark\n");
+        printf("Processes: %d, Iterations: %d (after %d warmup)\n",
+               size, NUM_ITERATIONS, NUM_WARMUP);
+        printf("Times are the slowest process, in microseconds. "
+               "Bandwidth = bytes per process / median time.\n");
+        printf("Bytes is the message size; allgather and alltoall move one per process.\n");
+    }
+
+    // Communicator sizes 2, 4, 8, ... and finally all processes
+    for (int nprocs = 2; ; nprocs *= 2) {
+        if (nprocs > size)
+            nprocs = size;
+
+        MPI_Comm comm;
+        MPI_Comm_split(MPI_COMM_WORLD, rank < nprocs ? 0 : MPI_UNDEFINED, rank, &comm);
+
+        if (rank == 0) {
+            printf("\n=== Communicator size %d ===\n", nprocs);
+            printf("%-10s %10s %11s %11s %11s %11s\n",
+                   "Operation", "Bytes", "p50", "p90", "p99", "MB/s");
+        }
+
+        if (comm != MPI_COMM_NULL) {
+            for (int op = 0; op < NUM_OPS; op++) {
+                if (only && strcmp(only, OP_NAMES[op]) != 0)
+                    continue;
+                for (int count = 1; count <= MAX_COUNT; count *= 4) {
+                    double times[NUM_ITERATIONS];
+                    time_collective(op, send_buf, recv_buf, count, comm, times);
+                    if (rank == 0) {
+                        double bytes = count * sizeof(double);
+                        double moved = bytes_per_process(op, count, nprocs);
+                        printf("%-10s %10.0f %11.2f %11.2f %11.2f %11.1f\n", OP_NAMES[op], bytes,
+                               percentile(times, 50) * 1e6, percentile(times, 90) * 1e6,
+                               percentile(times, 99) * 1e6, moved / percentile(times, 50) / 1e6);
+                    }
+                }
+            }
+            MPI_Comm_free(&comm);
+        }
+
+        if (nprocs == size)
+            break;
+    }
+
+    if (!only || strcmp(only, "iallreduce") == 0) {
+        if (rank == 0) {
+            printf("\n=== Non-blocking MPI_Iallreduce overlapped with compute (%d processes) ===\n", size);
+            printf("%-10s %10s %11s %11s %11s %10s\n",
+                   "Operation", "Bytes", "comm", "compute", "both", "overlap");
+        }
+        for (int count = 1; count <= MAX_COUNT; count *= 4) {
+            time_iallreduce(send_buf, recv_buf, count, MPI_COMM_WORLD, rank);
+        }
+    }
+
+    free(send_buf);
+    free(recv_buf);
+    MPI_Finalize();
+    return 0;
+}
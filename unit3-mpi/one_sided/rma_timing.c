@@ -0,0 +1,221 @@
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/******
+ * One-sided (RMA) version of the roundtrip demo.
+ *
+ * Two-sided MPI_Send/MPI_Recv needs a matching call on both processes.
+ * With one-sided communication, a process exposes a "window" of its
+ * memory, and other processes MPI_Put into it or MPI_Get out of it
+ * without the owner posting a receive. The catch is synchronization:
+ * somebody still has to say when the data is safe to read. MPI offers
+ * three ways to do that, and this demo times a ping-pong with each:
+ *
+ *   send  - two-sided MPI_Send/MPI_Recv (the baseline from roundtrip/)
+ *   fence - active target, MPI_Win_fence (collective over the window)
+ *   pscw  - active target, Post/Start/Complete/Wait (only the pair syncs)
+ *   lock  - passive target, MPI_Win_lock/unlock (process 1 does nothing!)
+ *
+ * For each message size we report the average roundtrip time and the
+ * bandwidth (2 * bytes / roundtrip).
+ ******/
+
+#define NUM_ITERATIONS 100
+#define MAX_COUNT (1 << 20)   // largest message, in doubles (8 MB)
+
+// Two-sided ping-pong, same as roundtrip/mpi_timing.c
+double time_send(double *send_buf, double *recv_buf, int count, int rank, MPI_Comm comm) {
+    MPI_Barrier(comm);
+    double start = MPI_Wtime();
+    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+        if (rank == 0) {
+            MPI_Send(send_buf, count, MPI_DOUBLE, 1, 0, comm);
+            MPI_Recv(recv_buf, count, MPI_DOUBLE, 1, 0, comm, MPI_STATUS_IGNORE);
+        } else {
+            MPI_Recv(recv_buf, count, MPI_DOUBLE, 0, 0, comm, MPI_STATUS_IGNORE);
+            MPI_Send(recv_buf, count, MPI_DOUBLE, 0, 0, comm);
+        }
+    }
+    return (MPI_Wtime() - start) / NUM_ITERATIONS;
+}
+
+// Fence: every process in the window calls MPI_Win_fence, and all RMA
+// issued between two fences is complete after the second one.
+double time_fence(double *send_buf, double *win_buf, int count, int rank, MPI_Win win) {
+    MPI_Win_fence(MPI_MODE_NOPRECEDE, win);
+    double start = MPI_Wtime();
+    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+        if (rank == 0)
+            MPI_Put(send_buf, count, MPI_DOUBLE, 1, 0, count, MPI_DOUBLE, win);
+        MPI_Win_fence(0, win);
+        // Process 1 bounces back what just landed in its window
+        if (rank == 1)
+            MPI_Put(win_buf, count, MPI_DOUBLE, 0, 0, count, MPI_DOUBLE, win);
+        MPI_Win_fence(0, win);
+    }
+    double elapsed = MPI_Wtime() - start;
+    MPI_Win_fence(MPI_MODE_NOSUCCEED, win);
+    return elapsed / NUM_ITERATIONS;
+}
+
+// Post/Start/Complete/Wait: the target "posts" its window to a group of
+// origins, and the origins "start" an access epoch to that group. Only
+// the processes that actually communicate have to synchronize.
+double time_pscw(double *send_buf, double *win_buf, int count, int rank,
+                 MPI_Group peer, MPI_Win win) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+        if (rank == 0) {
+            MPI_Win_start(peer, 0, win);
+            MPI_Put(send_buf, count, MPI_DOUBLE, 1, 0, count, MPI_DOUBLE, win);
+            MPI_Win_complete(win);
+
+            MPI_Win_post(peer, 0, win);
+            MPI_Win_wait(win);
+        } else {
+            MPI_Win_post(peer, 0, win);
+            MPI_Win_wait(win);
+
+            MPI_Win_start(peer, 0, win);
+            MPI_Put(win_buf, count, MPI_DOUBLE, 0, 0, count, MPI_DOUBLE, win);
+            MPI_Win_complete(win);
+        }
+    }
+    return (MPI_Wtime() - start) / NUM_ITERATIONS;
+}
+
+// Lock/unlock: process 0 writes into process 1's window and reads it back
+// on its own. Process 1 never makes a matching call - it just waits at
+// the barrier below until process 0 is done.
+double time_lock(double *send_buf, double *recv_buf, int count, int rank, MPI_Win win) {
+    double elapsed = 0.0;
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0) {
+        double start = MPI_Wtime();
+        for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+            MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 1, 0, win);
+            MPI_Put(send_buf, count, MPI_DOUBLE, 1, 0, count, MPI_DOUBLE, win);
+            MPI_Win_flush(1, win);   // put must land before we read it back
+            MPI_Get(recv_buf, count, MPI_DOUBLE, 1, 0, count, MPI_DOUBLE, win);
+            MPI_Win_unlock(1, win);
+        }
+        elapsed = MPI_Wtime() - start;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    return elapsed / NUM_ITERATIONS;
+}
+
+// Fill the window and the receive buffer with a value no message contains,
+// so each mode's check only passes if that mode's own transfer arrived.
+// We write our own window inside a lock on it, which keeps the stores
+// ordered with the other process's RMA that follows.
+void clear_buffers(double *win_buf, double *recv_buf, int count, int rank, MPI_Win win) {
+    MPI_Win_lock(MPI_LOCK_EXCLUSIVE, rank, 0, win);
+    for (int i = 0; i < count; i++)
+        win_buf[i] = -1.0;
+    MPI_Win_unlock(rank, win);
+    for (int i = 0; i < count; i++)
+        recv_buf[i] = -1.0;
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
+// Count elements of the returned message that don't match what we sent
+int count_errors(const double *sent, const double *received, int count) {
+    int errors = 0;
+    for (int i = 0; i < count; i++) {
+        if (sent[i] != received[i])
+            errors++;
+    }
+    return errors;
+}
+
+int main(int argc, char *argv[]) {
+    int rank, size;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (size != 2) {
+        if (rank == 0) {
+            printf("This program requires exactly 2 processes.\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    double *send_buf = malloc(MAX_COUNT * sizeof(double));
+    double *recv_buf = malloc(MAX_COUNT * sizeof(double));
+    for (int i = 0; i < MAX_COUNT; i++) {
+        send_buf[i] = rank * MAX_COUNT + i;
+    }
+
+    // MPI_Win_allocate lets the library pick memory that is cheap to
+    // expose (e.g. pre-registered with the network card)
+    double *win_buf;
+    MPI_Win win;
+    MPI_Win_allocate(MAX_COUNT * sizeof(double), sizeof(double), MPI_INFO_NULL,
+                     MPI_COMM_WORLD, &win_buf, &win);
+
+    // The group containing just the other process, for PSCW
+    int other_rank = 1 - rank;
+    MPI_Group world_group, peer;
+    MPI_Comm_group(MPI_COMM_WORLD, &world_group);
+    MPI_Group_incl(world_group, 1, &other_rank, &peer);
+
+    if (rank == 0) {
+        printf("MPI One-Sided (RMA) Timing Demo\n");
+        printf("Iterations per size: %d\n\n", NUM_ITERATIONS);
+        printf("%10s | %-41s | %-41s\n", "",
+               "        Roundtrip time (microseconds)", "          Bandwidth (MB/s)");
+        printf("%10s | %9s %9s %9s %9s  | %9s %9s %9s %9s\n", "Bytes",
+               "send", "fence", "pscw", "lock", "send", "fence", "pscw", "lock");
+        printf("-----------+-------------------------------------------+------------------------------------------\n");
+    }
+
+    int errors = 0;
+    for (int count = 1; count <= MAX_COUNT; count *= 4) {
+        double t[4];
+
+        clear_buffers(win_buf, recv_buf, count, rank, win);
+        t[0] = time_send(send_buf, recv_buf, count, rank, MPI_COMM_WORLD);
+        if (rank == 0)
+            errors += count_errors(send_buf, recv_buf, count);
+
+        clear_buffers(win_buf, recv_buf, count, rank, win);
+        t[1] = time_fence(send_buf, win_buf, count, rank, win);
+        if (rank == 0)
+            errors += count_errors(send_buf, win_buf, count);
+
+        clear_buffers(win_buf, recv_buf, count, rank, win);
+        t[2] = time_pscw(send_buf, win_buf, count, rank, peer, win);
+        if (rank == 0)
+            errors += count_errors(send_buf, win_buf, count);
+
+        clear_buffers(win_buf, recv_buf, count, rank, win);
+        t[3] = time_lock(send_buf, recv_buf, count, rank, win);
+        if (rank == 0)
+            errors += count_errors(send_buf, recv_buf, count);
+
+        if (rank == 0) {
+            double bytes = count * sizeof(double);
+            printf("%10.0f | %9.2f %9.2f %9.2f %9.2f  | %9.1f %9.1f %9.1f %9.1f\n", bytes,
+                   t[0] * 1e6, t[1] * 1e6, t[2] * 1e6, t[3] * 1e6,
+                   2 * bytes / t[0] / 1e6, 2 * bytes / t[1] / 1e6,
+                   2 * bytes / t[2] / 1e6, 2 * bytes / t[3] / 1e6);
+        }
+    }
+
+    if (rank == 0)
+        printf("\nData errors: %d\n", errors);
+
+    MPI_Group_free(&peer);
+    MPI_Group_free(&world_group);
+    MPI_Win_free(&win);
+    free(send_buf);
+    free(recv_buf);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,609 @@
+/*
+ * mpiprof - a tiny MPI profiler built on the PMPI interface.
+ *
+ * Every MPI function also exists under the name PMPI_<name>. If we define
+ * our own MPI_Send, the application calls ours instead of the library's,
+ * and ours can time the call and then hand it to PMPI_Send to do the real
+ * work. No changes to the application are needed: either link with
+ * -lmpiprof, or load the library at run time with LD_PRELOAD.
+ *
+ * What it records, per process:
+ *   - number of calls, total time and longest single call, per MPI function
+ *   - bytes sent to / received from each other process, including
+ *     one-sided MPI_Put (sent to the target) and MPI_Get (received from it)
+ *   - a timeline of every call, written to <prefix>.<rank>.trace
+ *
+ * At MPI_Finalize, process 0 prints a summary table for the whole job.
+ *
+ * A watchdog thread in each process prints a warning (naming the call, the
+ * peer and the tag) when that process has been stuck in one blocking call
+ * for longer than a threshold. In a deadlock every process prints one,
+ * so the set of warnings shows the whole cycle of pending operations.
+ *
+ * Environment variables:
+ *   MPIPROF_WATCHDOG  seconds before the watchdog complains (default 10, 0 = off)
+ *   MPIPROF_TRACE     trace file prefix (default "mpiprof", "" = no trace)
+ *
+ * The communication and synchronization calls used by the unit3-mpi demos
+ * are wrapped; setup calls (MPI_Comm_split, MPI_Win_create, ...) are not.
+ * The bookkeeping assumes the application calls MPI from a single thread.
+ */
+
+#include <mpi.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum {
+    CALL_SEND, CALL_RECV, CALL_ISEND, CALL_IRECV, CALL_WAIT, CALL_WAITALL,
+    CALL_SENDRECV, CALL_BARRIER, CALL_BCAST, CALL_REDUCE, CALL_ALLREDUCE,
+    CALL_ALLGATHER, CALL_ALLTOALL, CALL_IALLREDUCE, CALL_TEST,
+    CALL_PUT, CALL_GET, CALL_WIN_FENCE, CALL_WIN_START, CALL_WIN_COMPLETE,
+    CALL_WIN_POST, CALL_WIN_WAIT, CALL_WIN_LOCK, CALL_WIN_UNLOCK,
+    CALL_WIN_LOCK_ALL, CALL_WIN_UNLOCK_ALL, CALL_WIN_FLUSH, CALL_WIN_SYNC, NUM_CALLS
+};
+
+static const char *CALL_NAMES[NUM_CALLS] = {
+    "MPI_Send", "MPI_Recv", "MPI_Isend", "MPI_Irecv", "MPI_Wait", "MPI_Waitall",
+    "MPI_Sendrecv", "MPI_Barrier", "MPI_Bcast", "MPI_Reduce", "MPI_Allreduce",
+    "MPI_Allgather", "MPI_Alltoall", "MPI_Iallreduce", "MPI_Test",
+    "MPI_Put", "MPI_Get", "MPI_Win_fence", "MPI_Win_start", "MPI_Win_complete",
+    "MPI_Win_post", "MPI_Win_wait", "MPI_Win_lock", "MPI_Win_unlock",
+    "MPI_Win_lock_all", "MPI_Win_unlock_all", "MPI_Win_flush", "MPI_Win_sync"
+};
+
+// Per-function totals
+static long call_count[NUM_CALLS];
+static double call_time[NUM_CALLS];
+static double call_max[NUM_CALLS];
+static long call_bytes[NUM_CALLS];
+
+// Per-peer traffic, indexed by rank in MPI_COMM_WORLD
+static long *bytes_to;
+static long *bytes_from;
+
+// Timeline
+struct event {
+    double start, end;
+    int call, peer;
+    long bytes;
+};
+static struct event *events;
+static long num_events, max_events;
+
+static int prof_rank, prof_size;
+static double init_time;
+
+// What the watchdog needs to know about the call we are currently inside
+static volatile int blocked_call = -1;
+static volatile int blocked_peer, blocked_tag;
+static volatile long blocked_bytes;
+static volatile double blocked_since;
+static volatile long blocked_seq;
+
+static pthread_t watchdog_thread;
+static volatile int watchdog_running;
+static double watchdog_seconds = 10.0;
+
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Rank in MPI_COMM_WORLD of rank `rank` in comm (negative ranks pass through)
+static int world_rank_of(MPI_Comm comm, int rank) {
+    if (rank < 0 || comm == MPI_COMM_WORLD)
+        return rank;
+    MPI_Group group, world_group;
+    int world_rank;
+    PMPI_Comm_group(comm, &group);
+    PMPI_Comm_group(MPI_COMM_WORLD, &world_group);
+    PMPI_Group_translate_ranks(group, 1, &rank, world_group, &world_rank);
+    PMPI_Group_free(&group);
+    PMPI_Group_free(&world_group);
+    return world_rank;
+}
+
+// The same, for a target rank in a window's group
+static int world_rank_of_win(MPI_Win win, int rank) {
+    if (rank < 0)
+        return rank;   // MPI_PROC_NULL
+    MPI_Group group, world_group;
+    int world_rank;
+    PMPI_Win_get_group(win, &group);
+    PMPI_Comm_group(MPI_COMM_WORLD, &world_group);
+    PMPI_Group_translate_ranks(group, 1, &rank, world_group, &world_rank);
+    PMPI_Group_free(&group);
+    PMPI_Group_free(&world_group);
+    return world_rank;
+}
+
+static long message_bytes(int count, MPI_Datatype type) {
+    int type_size;
+    PMPI_Type_size(type, &type_size);
+    return (long)count * type_size;
+}
+
+// Call at the top of every wrapper. Returns the start time.
+static double enter(int call, int peer, int tag, long bytes) {
+    blocked_peer = peer;
+    blocked_tag = tag;
+    blocked_bytes = bytes;
+    blocked_since = now();
+    blocked_seq++;
+    blocked_call = call;
+    return blocked_since;
+}
+
+// Call at the bottom of every wrapper
+static void leave(int call, double start, int peer, long bytes) {
+    double end = now();
+    blocked_call = -1;
+
+    call_count[call]++;
+    call_time[call] += end - start;
+    if (end - start > call_max[call])
+        call_max[call] = end - start;
+    call_bytes[call] += bytes;
+
+    if (max_events > 0) {
+        if (num_events == max_events) {
+            struct event *bigger = realloc(events, 2 * max_events * sizeof(struct event));
+            if (!bigger) {
+                // Out of memory: keep what we have and stop recording
+                fprintf(stderr, "[mpiprof] rank %d: out of memory, trace truncated\n", prof_rank);
+                max_events = 0;
+                return;
+            }
+            events = bigger;
+            max_events *= 2;
+        }
+        struct event *e = &events[num_events++];
+        e->start = start - init_time;
+        e->end = end - init_time;
+        e->call = call;
+        e->peer = peer;
+        e->bytes = bytes;
+    }
+}
+
+static void *watchdog(void *arg) {
+    long warned_seq = -1;
+    while (watchdog_running) {
+        usleep(100000);
+        int call = blocked_call;
+        long seq = blocked_seq;
+        double waited = now() - blocked_since;
+        if (call >= 0 && seq != warned_seq && waited > watchdog_seconds) {
+            fprintf(stderr, "[mpiprof] WARNING: rank %d blocked for %.1f s in %s "
+                    "(peer=%d, tag=%d, %ld bytes)\n", prof_rank, waited,
+                    CALL_NAMES[call], blocked_peer, blocked_tag, blocked_bytes);
+            warned_seq = seq;
+        }
+    }
+    return NULL;
+}
+
+static void profiler_start(void) {
+    PMPI_Comm_rank(MPI_COMM_WORLD, &prof_rank);
+    PMPI_Comm_size(MPI_COMM_WORLD, &prof_size);
+    bytes_to = calloc(prof_size, sizeof(long));
+    bytes_from = calloc(prof_size, sizeof(long));
+
+    const char *prefix = getenv("MPIPROF_TRACE");
+    if (!prefix || prefix[0] != '\0') {
+        max_events = 1024;
+        events = malloc(max_events * sizeof(struct event));
+    }
+
+    const char *threshold = getenv("MPIPROF_WATCHDOG");
+    if (threshold)
+        watchdog_seconds = atof(threshold);
+    if (watchdog_seconds > 0) {
+        watchdog_running = 1;
+        pthread_create(&watchdog_thread, NULL, watchdog, NULL);
+    }
+
+    init_time = now();
+}
+
+static void write_trace(void) {
+    const char *prefix = getenv("MPIPROF_TRACE");
+    if (!events)
+        return;
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s.%d.trace", prefix ? prefix : "mpiprof", prof_rank);
+    FILE *f = fopen(filename, "w");
+    if (!f) {
+        fprintf(stderr, "[mpiprof] rank %d: could not write %s\n", prof_rank, filename);
+        return;
+    }
+    fprintf(f, "# rank start_s end_s call peer bytes\n");
+    for (long i = 0; i < num_events; i++) {
+        struct event *e = &events[i];
+        fprintf(f, "%d %.9f %.9f %s %d %ld\n", prof_rank, e->start, e->end,
+                CALL_NAMES[e->call], e->peer, e->bytes);
+    }
+    fclose(f);
+}
+
+static void print_matrix(const char *title, const long *matrix) {
+    printf("\n%s:\n%6s", title, "");
+    for (int r = 0; r < prof_size; r++)
+        printf(" %11d", r);
+    printf("\n");
+    for (int s = 0; s < prof_size; s++) {
+        printf("%6d", s);
+        for (int r = 0; r < prof_size; r++)
+            printf(" %11ld", matrix[s * prof_size + r]);
+        printf("\n");
+    }
+}
+
+static void print_summary(double wall) {
+    double mpi_time = 0.0;
+    for (int c = 0; c < NUM_CALLS; c++)
+        mpi_time += call_time[c];
+
+    // Combine per-function totals across the job
+    long total_count[NUM_CALLS], total_bytes[NUM_CALLS];
+    double total_time[NUM_CALLS], worst_time[NUM_CALLS];
+    PMPI_Reduce(call_count, total_count, NUM_CALLS, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(call_bytes, total_bytes, NUM_CALLS, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(call_time, total_time, NUM_CALLS, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(call_max, worst_time, NUM_CALLS, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    // Per-process time split
+    double mine[2] = { wall, mpi_time };
+    double *all = prof_rank == 0 ? malloc(2 * prof_size * sizeof(double)) : NULL;
+    PMPI_Gather(mine, 2, MPI_DOUBLE, all, 2, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    // Traffic matrix, only for jobs small enough to print
+    long *matrix = NULL, *from_matrix = NULL;
+    if (prof_size <= 16) {
+        if (prof_rank == 0) {
+            matrix = malloc(prof_size * prof_size * sizeof(long));
+            from_matrix = malloc(prof_size * prof_size * sizeof(long));
+        }
+        PMPI_Gather(bytes_to, prof_size, MPI_LONG, matrix, prof_size, MPI_LONG, 0, MPI_COMM_WORLD);
+        PMPI_Gather(bytes_from, prof_size, MPI_LONG, from_matrix, prof_size, MPI_LONG,
+                    0, MPI_COMM_WORLD);
+    }
+
+    if (prof_rank != 0)
+        return;
+
+    printf("\n=== mpiprof summary (%d processes) ===\n", prof_size);
+    printf("%-18s %10s %12s %12s %14s\n", "Call", "Count", "Total (s)", "Max (s)", "Bytes");
+    for (int c = 0; c < NUM_CALLS; c++) {
+        if (total_count[c] == 0)
+            continue;
+        printf("%-18s %10ld %12.6f %12.6f %14ld\n", CALL_NAMES[c], total_count[c],
+               total_time[c], worst_time[c], total_bytes[c]);
+    }
+
+    printf("\n%-6s %12s %12s %8s\n", "Rank", "Wall (s)", "In MPI (s)", "MPI %");
+    for (int r = 0; r < prof_size; r++) {
+        double w = all[2 * r], m = all[2 * r + 1];
+        printf("%-6d %12.6f %12.6f %7.1f%%\n", r, w, m, w > 0 ? 100.0 * m / w : 0.0);
+    }
+    free(all);
+
+    if (matrix) {
+        print_matrix("Bytes sent (row = sender, column = receiver, MPI_Put included)", matrix);
+        print_matrix("Bytes received (row = receiver, column = sender, MPI_Get included;\n"
+                     "MPI_Irecv counts the posted size)", from_matrix);
+        free(matrix);
+        free(from_matrix);
+    }
+    fflush(stdout);
+}
+
+
+/* ---------- Setup and teardown ---------- */
+
+int MPI_Init(int *argc, char ***argv) {
+    int result = PMPI_Init(argc, argv);
+    profiler_start();
+    return result;
+}
+
+int MPI_Init_thread(int *argc, char ***argv, int required, int *provided) {
+    int result = PMPI_Init_thread(argc, argv, required, provided);
+    profiler_start();
+    return result;
+}
+
+int MPI_Finalize(void) {
+    double wall = now() - init_time;
+    if (watchdog_running) {
+        watchdog_running = 0;
+        pthread_join(watchdog_thread, NULL);
+    }
+    write_trace();
+    print_summary(wall);
+    free(events);
+    free(bytes_to);
+    free(bytes_from);
+    return PMPI_Finalize();
+}
+
+
+/* ---------- Point-to-point ---------- */
+
+int MPI_Send(const void *buf, int count, MPI_Datatype type, int dest, int tag, MPI_Comm comm) {
+    long bytes = message_bytes(count, type);
+    int peer = world_rank_of(comm, dest);
+    double start = enter(CALL_SEND, peer, tag, bytes);
+    int result = PMPI_Send(buf, count, type, dest, tag, comm);
+    if (peer >= 0)
+        bytes_to[peer] += bytes;
+    leave(CALL_SEND, start, peer, bytes);
+    return result;
+}
+
+int MPI_Recv(void *buf, int count, MPI_Datatype type, int source, int tag,
+             MPI_Comm comm, MPI_Status *status) {
+    MPI_Status local_status;
+    if (status == MPI_STATUS_IGNORE)
+        status = &local_status;
+
+    double start = enter(CALL_RECV, world_rank_of(comm, source), tag, message_bytes(count, type));
+    int result = PMPI_Recv(buf, count, type, source, tag, comm, status);
+
+    // Now we know who actually sent it, and how much
+    int received;
+    PMPI_Get_count(status, type, &received);
+    long bytes = message_bytes(received, type);
+    int peer = world_rank_of(comm, status->MPI_SOURCE);
+    if (peer >= 0)
+        bytes_from[peer] += bytes;
+    leave(CALL_RECV, start, peer, bytes);
+    return result;
+}
+
+int MPI_Sendrecv(const void *sendbuf, int sendcount, MPI_Datatype sendtype, int dest, int sendtag,
+                 void *recvbuf, int recvcount, MPI_Datatype recvtype, int source, int recvtag,
+                 MPI_Comm comm, MPI_Status *status) {
+    long send_bytes = message_bytes(sendcount, sendtype);
+    long recv_bytes = message_bytes(recvcount, recvtype);
+    int to = world_rank_of(comm, dest), from = world_rank_of(comm, source);
+    double start = enter(CALL_SENDRECV, to, sendtag, send_bytes);
+    int result = PMPI_Sendrecv(sendbuf, sendcount, sendtype, dest, sendtag,
+                               recvbuf, recvcount, recvtype, source, recvtag, comm, status);
+    if (to >= 0)
+        bytes_to[to] += send_bytes;
+    if (from >= 0)
+        bytes_from[from] += recv_bytes;
+    leave(CALL_SENDRECV, start, to, send_bytes + recv_bytes);
+    return result;
+}
+
+// Non-blocking calls return right away; the waiting shows up in MPI_Wait*
+int MPI_Isend(const void *buf, int count, MPI_Datatype type, int dest, int tag,
+              MPI_Comm comm, MPI_Request *request) {
+    long bytes = message_bytes(count, type);
+    int peer = world_rank_of(comm, dest);
+    double start = enter(CALL_ISEND, peer, tag, bytes);
+    int result = PMPI_Isend(buf, count, type, dest, tag, comm, request);
+    if (peer >= 0)
+        bytes_to[peer] += bytes;
+    leave(CALL_ISEND, start, peer, bytes);
+    return result;
+}
+
+int MPI_Irecv(void *buf, int count, MPI_Datatype type, int source, int tag,
+              MPI_Comm comm, MPI_Request *request) {
+    long bytes = message_bytes(count, type);   // posted size, not received size
+    int peer = world_rank_of(comm, source);
+    double start = enter(CALL_IRECV, peer, tag, bytes);
+    int result = PMPI_Irecv(buf, count, type, source, tag, comm, request);
+    if (peer >= 0)
+        bytes_from[peer] += bytes;
+    leave(CALL_IRECV, start, peer, bytes);
+    return result;
+}
+
+int MPI_Wait(MPI_Request *request, MPI_Status *status) {
+    double start = enter(CALL_WAIT, -1, -1, 0);
+    int result = PMPI_Wait(request, status);
+    leave(CALL_WAIT, start, -1, 0);
+    return result;
+}
+
+int MPI_Waitall(int count, MPI_Request requests[], MPI_Status statuses[]) {
+    double start = enter(CALL_WAITALL, -1, -1, 0);
+    int result = PMPI_Waitall(count, requests, statuses);
+    leave(CALL_WAITALL, start, -1, 0);
+    return result;
+}
+
+int MPI_Test(MPI_Request *request, int *flag, MPI_Status *status) {
+    double start = enter(CALL_TEST, -1, -1, 0);
+    int result = PMPI_Test(request, flag, status);
+    leave(CALL_TEST, start, -1, 0);
+    return result;
+}
+
+
+/* ---------- Collectives ---------- */
+
+int MPI_Barrier(MPI_Comm comm) {
+    double start = enter(CALL_BARRIER, -1, -1, 0);
+    int result = PMPI_Barrier(comm);
+    leave(CALL_BARRIER, start, -1, 0);
+    return result;
+}
+
+int MPI_Bcast(void *buf, int count, MPI_Datatype type, int root, MPI_Comm comm) {
+    long bytes = message_bytes(count, type);
+    int peer = world_rank_of(comm, root);
+    double start = enter(CALL_BCAST, peer, -1, bytes);
+    int result = PMPI_Bcast(buf, count, type, root, comm);
+    leave(CALL_BCAST, start, peer, bytes);
+    return result;
+}
+
+int MPI_Reduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype type,
+               MPI_Op op, int root, MPI_Comm comm) {
+    long bytes = message_bytes(count, type);
+    int peer = world_rank_of(comm, root);
+    double start = enter(CALL_REDUCE, peer, -1, bytes);
+    int result = PMPI_Reduce(sendbuf, recvbuf, count, type, op, root, comm);
+    leave(CALL_REDUCE, start, peer, bytes);
+    return result;
+}
+
+int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype type,
+                  MPI_Op op, MPI_Comm comm) {
+    long bytes = message_bytes(count, type);
+    double start = enter(CALL_ALLREDUCE, -1, -1, bytes);
+    int result = PMPI_Allreduce(sendbuf, recvbuf, count, type, op, comm);
+    leave(CALL_ALLREDUCE, start, -1, bytes);
+    return result;
+}
+
+int MPI_Allgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                  void *recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+    long bytes = message_bytes(sendcount, sendtype);
+    double start = enter(CALL_ALLGATHER, -1, -1, bytes);
+    int result = PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+    leave(CALL_ALLGATHER, start, -1, bytes);
+    return result;
+}
+
+int MPI_Alltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                 void *recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+    int comm_size;
+    PMPI_Comm_size(comm, &comm_size);
+    long bytes = message_bytes(sendcount, sendtype) * comm_size;
+    double start = enter(CALL_ALLTOALL, -1, -1, bytes);
+    int result = PMPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+    leave(CALL_ALLTOALL, start, -1, bytes);
+    return result;
+}
+
+int MPI_Iallreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype type,
+                   MPI_Op op, MPI_Comm comm, MPI_Request *request) {
+    long bytes = message_bytes(count, type);
+    double start = enter(CALL_IALLREDUCE, -1, -1, bytes);
+    int result = PMPI_Iallreduce(sendbuf, recvbuf, count, type, op, comm, request);
+    leave(CALL_IALLREDUCE, start, -1, bytes);
+    return result;
+}
+
+
+/* ---------- One-sided ---------- */
+
+int MPI_Win_fence(int assert, MPI_Win win) {
+    double start = enter(CALL_WIN_FENCE, -1, -1, 0);
+    int result = PMPI_Win_fence(assert, win);
+    leave(CALL_WIN_FENCE, start, -1, 0);
+    return result;
+}
+
+// Put and Get only start the transfer; like Isend, the wait shows up in
+// whichever synchronization call completes it
+int MPI_Put(const void *origin, int origin_count, MPI_Datatype origin_type, int target,
+            MPI_Aint target_disp, int target_count, MPI_Datatype target_type, MPI_Win win) {
+    long bytes = message_bytes(origin_count, origin_type);
+    int peer = world_rank_of_win(win, target);
+    double start = enter(CALL_PUT, peer, -1, bytes);
+    int result = PMPI_Put(origin, origin_count, origin_type, target, target_disp,
+                          target_count, target_type, win);
+    if (peer >= 0)
+        bytes_to[peer] += bytes;
+    leave(CALL_PUT, start, peer, bytes);
+    return result;
+}
+
+int MPI_Get(void *origin, int origin_count, MPI_Datatype origin_type, int target,
+            MPI_Aint target_disp, int target_count, MPI_Datatype target_type, MPI_Win win) {
+    long bytes = message_bytes(origin_count, origin_type);
+    int peer = world_rank_of_win(win, target);
+    double start = enter(CALL_GET, peer, -1, bytes);
+    int result = PMPI_Get(origin, origin_count, origin_type, target, target_disp,
+                          target_count, target_type, win);
+    if (peer >= 0)
+        bytes_from[peer] += bytes;
+    leave(CALL_GET, start, peer, bytes);
+    return result;
+}
+
+int MPI_Win_start(MPI_Group group, int assert, MPI_Win win) {
+    double start = enter(CALL_WIN_START, -1, -1, 0);
+    int result = PMPI_Win_start(group, assert, win);
+    leave(CALL_WIN_START, start, -1, 0);
+    return result;
+}
+
+int MPI_Win_complete(MPI_Win win) {
+    double start = enter(CALL_WIN_COMPLETE, -1, -1, 0);
+    int result = PMPI_Win_complete(win);
+    leave(CALL_WIN_COMPLETE, start, -1, 0);
+    return result;
+}
+
+int MPI_Win_post(MPI_Group group, int assert, MPI_Win win) {
+    double start = enter(CALL_WIN_POST, -1, -1, 0);
+    int result = PMPI_Win_post(group, assert, win);
+    leave(CALL_WIN_POST, start, -1, 0);
+    return result;
+}
+
+int MPI_Win_wait(MPI_Win win) {
+    double start = enter(CALL_WIN_WAIT, -1, -1, 0);
+    int result = PMPI_Win_wait(win);
+    leave(CALL_WIN_WAIT, start, -1, 0);
+    return result;
+}
+
+int MPI_Win_lock(int lock_type, int rank, int assert, MPI_Win win) {
+    int peer = world_rank_of_win(win, rank);
+    double start = enter(CALL_WIN_LOCK, peer, -1, 0);
+    int result = PMPI_Win_lock(lock_type, rank, assert, win);
+    leave(CALL_WIN_LOCK, start, peer, 0);
+    return result;
+}
+
+int MPI_Win_unlock(int rank, MPI_Win win) {
+    int peer = world_rank_of_win(win, rank);
+    double start = enter(CALL_WIN_UNLOCK, peer, -1, 0);
+    int result = PMPI_Win_unlock(rank, win);
+    leave(CALL_WIN_UNLOCK, start, peer, 0);
+    return result;
+}
+
+int MPI_Win_lock_all(int assert, MPI_Win win) {
+    double start = enter(CALL_WIN_LOCK_ALL, -1, -1, 0);
+    int result = PMPI_Win_lock_all(assert, win);
+    leave(CALL_WIN_LOCK_ALL, start, -1, 0);
+    return result;
+}
+
+int MPI_Win_unlock_all(MPI_Win win) {
+    double start = enter(CALL_WIN_UNLOCK_ALL, -1, -1, 0);
+    int result = PMPI_Win_unlock_all(win);
+    leave(CALL_WIN_UNLOCK_ALL, start, -1, 0);
+    return result;
+}
+
+int MPI_Win_flush(int rank, MPI_Win win) {
+    int peer = world_rank_of_win(win, rank);
+    double start = enter(CALL_WIN_FLUSH, peer, -1, 0);
+    int result = PMPI_Win_flush(rank, win);
+    leave(CALL_WIN_FLUSH, start, peer, 0);
+    return result;
+}
+
+int MPI_Win_sync(MPI_Win win) {
+    double start = enter(CALL_WIN_SYNC, -1, -1, 0);
+    int result = PMPI_Win_sync(win);
+    leave(CALL_WIN_SYNC, start, -1, 0);
+    return result;
+}
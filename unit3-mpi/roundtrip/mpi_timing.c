@@ -1,15 +1,95 @@
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define NUM_ITERATIONS 100
 #define DATA_SIZE 1000
+#define FLAG_PAD 16     // ints: keep each flag on its own cache line
+
+/*
+ * Usage: mpi_timing [send|shm]
+ *
+ * "send" (the default) times a ping-pong with MPI_Send/MPI_Recv. Even when
+ * both processes are on the same node, the library copies the message into
+ * a shared buffer and back out again.
+ *
+ * "shm" groups processes by node with MPI_Comm_split_type and gives each
+ * one a segment of an MPI_Win_allocate_shared window. Process 0 builds its
+ * message in its own segment, and process 1 reads it in place - one plain
+ * memcpy per direction, synchronized by a flag. If processes 0 and 1 are on
+ * different nodes, we fall back to send/recv. The flags are spin-waited
+ * on, so give each process its own core or this mode will crawl.
+ */
+
+// Which rank of node_comm is this world rank? (MPI_UNDEFINED if another node)
+int node_rank_of(MPI_Comm node_comm, int world_rank) {
+    MPI_Group world_group, node_group;
+    int node_rank;
+    MPI_Comm_group(MPI_COMM_WORLD, &world_group);
+    MPI_Comm_group(node_comm, &node_group);
+    MPI_Group_translate_ranks(world_group, 1, &world_rank, node_group, &node_rank);
+    MPI_Group_free(&world_group);
+    MPI_Group_free(&node_group);
+    return node_rank;
+}
+
+// Ping-pong through a shared-memory window. Each segment is a flag followed
+// by DATA_SIZE ints; a process sets its flag to iter+1 once its data is ready.
+// The caller must hold a lock_all epoch on win and have zeroed both flags.
+void pingpong_shared(MPI_Win win, MPI_Comm node_comm, int rank, double *times) {
+    MPI_Aint seg_size;
+    int disp_unit;
+    int *mine, *theirs;
+    MPI_Win_shared_query(win, node_rank_of(node_comm, rank), &seg_size, &disp_unit, &mine);
+    MPI_Win_shared_query(win, node_rank_of(node_comm, 1 - rank), &seg_size, &disp_unit, &theirs);
+
+    volatile int *my_flag = mine;
+    volatile int *their_flag = theirs;
+    int *my_data = mine + FLAG_PAD;
+    int *their_data = theirs + FLAG_PAD;
+
+    // Process 0 builds its message directly in shared memory
+    if (rank == 0) {
+        for (int i = 0; i < DATA_SIZE; i++) {
+            my_data[i] = i;
+        }
+    }
+
+    for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+        double start_time = MPI_Wtime();
+
+        if (rank == 0) {
+            // "Send": publish our segment
+            MPI_Win_sync(win);
+            *my_flag = iter + 1;
+            MPI_Win_sync(win);
+        }
+
+        // "Receive": wait for the other side, then copy straight out of its segment
+        while (*their_flag != iter + 1) {
+            MPI_Win_sync(win);
+        }
+        memcpy(my_data, their_data, DATA_SIZE * sizeof(int));
+
+        if (rank == 1) {
+            // "Send back": publish our copy
+            MPI_Win_sync(win);
+            *my_flag = iter + 1;
+            MPI_Win_sync(win);
+        }
+
+        times[iter] = MPI_Wtime() - start_time;
+    }
+}
 
 int main(int argc, char *argv[]) {
     int rank, size;
     double start_time, end_time, total_time = 0.0;
     double times[NUM_ITERATIONS];
     int *data;
+    int shm_requested = argc > 1 && strcmp(argv[1], "shm") == 0;
+    int use_shared = shm_requested;
     
     MPI_Init(&argc, &argv);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -25,8 +105,47 @@ int main(int argc, char *argv[]) {
     
     // Allocate data array
     data = (int*)malloc(DATA_SIZE * sizeof(int));
-    
-    if (rank == 0) {
+
+    MPI_Comm node_comm;
+    MPI_Win win;
+    if (use_shared) {
+        // Group processes by node. Rank 0 decides whether 0 and 1 share one,
+        // so that every process agrees on whether to build the window.
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+        use_shared = node_rank_of(node_comm, 0) != MPI_UNDEFINED &&
+                     node_rank_of(node_comm, 1) != MPI_UNDEFINED;
+        MPI_Bcast(&use_shared, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+        if (use_shared) {
+            int *segment;
+            MPI_Aint seg_size = rank < 2 ? (FLAG_PAD + DATA_SIZE) * sizeof(int) : 0;
+            MPI_Win_allocate_shared(seg_size, sizeof(int), MPI_INFO_NULL, node_comm, &segment, &win);
+
+            // Clear our flag, and make sure everyone sees it before starting
+            MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+            if (rank < 2)
+                segment[0] = 0;
+            MPI_Win_sync(win);
+            MPI_Barrier(MPI_COMM_WORLD);
+            MPI_Win_sync(win);
+        } else if (rank == 0) {
+            printf("Processes 0 and 1 are on different nodes: falling back to MPI_Send/MPI_Recv\n\n");
+        }
+    }
+
+    if (use_shared) {
+        if (rank == 0) {
+            printf("MPI Shared-Memory Window Timing Demo\n");
+            printf("Data size: %d integers\n", DATA_SIZE);
+            printf("Iterations: %d\n\n", NUM_ITERATIONS);
+        }
+        if (rank < 2) {
+            pingpong_shared(win, node_comm, rank, times);
+            for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+                total_time += times[iter];
+            }
+        }
+    } else if (rank == 0) {
         printf("MPI Send/Recv Timing Demo\n");
         printf("Data size: %d integers\n", DATA_SIZE);
         printf("Iterations: %d\n\n", NUM_ITERATIONS);
@@ -47,7 +166,15 @@ int main(int argc, char *argv[]) {
             times[iter] = end_time - start_time;
             total_time += times[iter];
         }
-        
+    } else if (rank == 1) {
+        // Process 1: receive and send back
+        for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
+            MPI_Recv(data, DATA_SIZE, MPI_INT, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(data, DATA_SIZE, MPI_INT, 0, 0, MPI_COMM_WORLD);
+        }
+    }
+
+    if (rank == 0) {
         // Calculate statistics
         double avg_time = total_time / NUM_ITERATIONS;
         double min_time = times[0], max_time = times[0];
@@ -62,15 +189,15 @@ int main(int argc, char *argv[]) {
         printf("Minimum time: %.6f seconds\n", min_time);
         printf("Maximum time: %.6f seconds\n", max_time);
         printf("Total time:   %.6f seconds\n", total_time);
-        
-    } else if (rank == 1) {
-        // Process 1: receive and send back
-        for (int iter = 0; iter < NUM_ITERATIONS; iter++) {
-            MPI_Recv(data, DATA_SIZE, MPI_INT, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            MPI_Send(data, DATA_SIZE, MPI_INT, 0, 0, MPI_COMM_WORLD);
-        }
+        printf("Bandwidth:    %.1f MB/s\n", 2.0 * DATA_SIZE * sizeof(int) / avg_time / 1e6);
     }
-    
+
+    if (use_shared) {
+        MPI_Win_unlock_all(win);
+        MPI_Win_free(&win);
+    }
+    if (shm_requested)
+        MPI_Comm_free(&node_comm);
     free(data);
     MPI_Finalize();
     return 0;
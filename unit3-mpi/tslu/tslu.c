@@ -0,0 +1,402 @@
+#include <mpi.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******
+ * Tall-skinny LU: column-by-column pivoting vs. tournament pivoting.
+ *
+ * A distributed LU (lu_demo.c's algorithm spread over processes) works on
+ * one panel of b columns at a time. The panel is tall and skinny: all n
+ * rows, split across the processes, but only b columns. Factoring it with
+ * ordinary partial pivoting goes one column at a time, and every column
+ * needs the whole machine to agree on a pivot:
+ *
+ *   for each of the b columns:
+ *       MPI_Allreduce (MAXLOC)   who has the biggest entry?
+ *       MPI_Bcast                send that row to everyone
+ *       update my rows
+ *
+ * That's 2b collectives, each about log2(P) message latencies long, and
+ * only a tiny bit of arithmetic between them. With many processes the
+ * panel is all waiting.
+ *
+ * TSLU (Grigori, Demmel and Xiang, "CALU: a communication optimal LU
+ * factorization algorithm", 2011) picks all b pivot rows at once with a
+ * tournament:
+ *
+ *   1. Each process runs partial pivoting on its own rows, with no
+ *      communication, and nominates the b rows it picked.
+ *   2. Pairs of processes play off up a binary tree: stack the two sets
+ *      of b candidates, run partial pivoting on those 2b rows, and keep
+ *      the b winners. After log2(P) rounds, process 0 has the b pivots.
+ *   3. Process 0 factors those b rows and broadcasts the result. Every
+ *      process then computes its part of L with a triangular solve.
+ *
+ * That's log2(P) messages up the tree and one broadcast, no matter how
+ * wide the panel. The winners aren't always the rows partial pivoting
+ * would pick, but they're picked the same way, and in practice it is
+ * just as stable. We print the residual and largest |L| so you can check.
+ *
+ * The price is arithmetic: each process eliminates its rows twice (once to
+ * nominate, once to compute L), so on one process TSLU is about 2x slower.
+ * It wins when latency is the bottleneck: many processes, few rows each,
+ * or a slow network.
+ *
+ * CALU is this panel step inside a blocked LU (like lu_factorize_blocked
+ * in unit2-serial/profiling/lu_demo.c): TSLU each panel, apply its row
+ * swaps, then update the trailing matrix as usual. The trailing update is
+ * the same for both pivoting schemes, so we only time the panel.
+ *
+ * The benchmark grows the panel with the number of processes (a fixed
+ * number of rows per process) and runs on 1, 2, 4, ... of them.
+ *
+ * Usage: tslu [rows_per_process=10000] [b=32] [reps=5]
+ ******/
+
+// How much communication did a factorization do, on this process?
+typedef struct {
+    int collectives;      // collective calls (Allreduce, Bcast)
+    int messages;         // point-to-point messages sent
+    int latency_steps;    // messages in a row on the critical path
+} comm_counts;
+
+// ceil(log2(p)): the depth of a binary tree over p processes
+int tree_depth(int p) {
+    int depth = 0;
+    while ((1 << depth) < p)
+        depth++;
+    return depth;
+}
+
+// A random panel: rows_local x b, column-major, the same for every run
+void random_panel(double *A, int rows_local, int b, int rank) {
+    unsigned int state = 12345u + 7919u * (unsigned int)rank;
+    for (int i = 0; i < rows_local * b; i++) {
+        state = state * 1103515245u + 12345u;
+        A[i] = (double)(state >> 8) / (1 << 24) - 0.5;
+    }
+}
+
+
+/* ---------- Column-by-column partial pivoting ---------- */
+
+// Factor the panel: afterwards, row i of A (global row offset + i) holds its
+// row of L, and U (b x b, row-major, on every process) is the upper factor.
+// perm[k] is the global index of the k-th pivot row.
+//
+// We don't swap rows between processes; each row stays where it is and we
+// just remember which rows have been used as pivots. A pivot row's L row is
+// the multipliers left of its pivot column, then 1, then zeros.
+void panel_by_columns(double *A, int rows_local, int b, int offset, double *U,
+                      int *perm, comm_counts *counts, MPI_Comm comm) {
+    int p;
+    MPI_Comm_size(comm, &p);
+    char *used = calloc(rows_local, 1);
+    double *row = malloc(b * sizeof(double));
+
+    for (int j = 0; j < b; j++) {
+        // Find the biggest unused entry in column j, across all processes
+        struct { double value; int index; } mine = { -1.0, -1 }, best;
+        for (int i = 0; i < rows_local; i++) {
+            if (!used[i] && fabs(A[i + j * rows_local]) > mine.value) {
+                mine.value = fabs(A[i + j * rows_local]);
+                mine.index = offset + i;
+            }
+        }
+        MPI_Allreduce(&mine, &best, 1, MPI_DOUBLE_INT, MPI_MAXLOC, comm);
+
+        // Its owner sends the pivot row (columns j..b-1) to everyone
+        int owner = best.index / rows_local;
+        if (best.index >= offset && best.index < offset + rows_local) {
+            int i = best.index - offset;
+            used[i] = 1;
+            for (int c = j; c < b; c++)
+                row[c] = A[i + c * rows_local];
+        }
+        MPI_Bcast(row + j, b - j, MPI_DOUBLE, owner, comm);
+        perm[j] = best.index;
+        for (int c = 0; c < b; c++)
+            U[j * b + c] = c < j ? 0.0 : row[c];
+        if (best.index >= offset && best.index < offset + rows_local) {
+            int i = best.index - offset;
+            A[i + j * rows_local] = 1.0;
+            for (int c = j + 1; c < b; c++)
+                A[i + c * rows_local] = 0.0;
+        }
+
+        // Eliminate column j from my remaining rows, a column at a time
+        if (row[j] == 0.0)
+            continue;    // column already zero: nothing to eliminate
+        for (int i = 0; i < rows_local; i++)
+            if (!used[i])
+                A[i + j * rows_local] /= row[j];
+        for (int c = j + 1; c < b; c++) {
+            for (int i = 0; i < rows_local; i++)
+                if (!used[i])
+                    A[i + c * rows_local] -= A[i + j * rows_local] * row[c];
+        }
+    }
+
+    counts->collectives += 2 * b;
+    counts->latency_steps += 2 * b * tree_depth(p);
+    free(used);
+    free(row);
+}
+
+
+/* ---------- Tournament pivoting (TSLU) ---------- */
+
+// Partial pivoting on nrows x b candidate rows (row-major), without
+// changing them. chosen[k] = which row was the k-th pivot.
+void choose_pivot_rows(const double *rows, int nrows, int b, int *chosen) {
+    double *work = malloc((size_t)nrows * b * sizeof(double));
+    char *used = calloc(nrows, 1);
+    memcpy(work, rows, (size_t)nrows * b * sizeof(double));
+
+    for (int j = 0; j < b; j++) {
+        int pivot = 0;
+        while (used[pivot])
+            pivot++;
+        for (int i = pivot + 1; i < nrows; i++)
+            if (!used[i] && fabs(work[i * b + j]) > fabs(work[pivot * b + j]))
+                pivot = i;
+        chosen[j] = pivot;
+        used[pivot] = 1;
+        if (work[pivot * b + j] == 0.0)
+            continue;    // column already zero: nothing to eliminate
+        for (int i = 0; i < nrows; i++) {
+            if (used[i])
+                continue;
+            double l = work[i * b + j] / work[pivot * b + j];
+            for (int c = j + 1; c < b; c++)
+                work[i * b + c] -= l * work[pivot * b + c];
+        }
+    }
+    free(work);
+    free(used);
+}
+
+// Keep the b winners of a round: copy the chosen rows (original values,
+// in pivot order) and their global indices to the front of the arrays
+void keep_winners(double *rows, double *index, int nrows, int b) {
+    int *chosen = malloc(b * sizeof(int));
+    double *winners = malloc((size_t)b * (b + 1) * sizeof(double));
+    choose_pivot_rows(rows, nrows, b, chosen);
+    for (int k = 0; k < b; k++) {
+        memcpy(winners + k * b, rows + chosen[k] * b, b * sizeof(double));
+        winners[b * b + k] = index[chosen[k]];
+    }
+    memcpy(rows, winners, (size_t)b * b * sizeof(double));
+    memcpy(index, winners + b * b, b * sizeof(double));
+    free(chosen);
+    free(winners);
+}
+
+// Same result layout as panel_by_columns. Needs rows_local >= b.
+void panel_tournament(double *A, int rows_local, int b, int offset, double *U,
+                      int *perm, comm_counts *counts, MPI_Comm comm) {
+    int rank, p;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &p);
+
+    // Candidates travel as one message: b rows of b values, then b global
+    // row indices (stored as doubles, which hold them exactly). We keep
+    // room for a second set of candidates after our own.
+    double *cand = malloc((size_t)2 * b * b * sizeof(double));
+    double *index = malloc(2 * b * sizeof(double));
+    double *message = malloc((size_t)b * (b + 1) * sizeof(double));
+
+    // Round 0: nominate b of my own rows
+    double *mine = malloc((size_t)rows_local * b * sizeof(double));
+    double *mine_index = malloc(rows_local * sizeof(double));
+    for (int i = 0; i < rows_local; i++) {
+        for (int c = 0; c < b; c++)
+            mine[i * b + c] = A[i + c * rows_local];
+        mine_index[i] = offset + i;
+    }
+    keep_winners(mine, mine_index, rows_local, b);
+    memcpy(cand, mine, (size_t)b * b * sizeof(double));
+    memcpy(index, mine_index, b * sizeof(double));
+    free(mine);
+    free(mine_index);
+
+    // The tournament: a binary tree with process 0 at the root
+    for (int step = 1; step < p; step *= 2) {
+        if (rank % (2 * step) == step) {
+            memcpy(message, cand, (size_t)b * b * sizeof(double));
+            memcpy(message + b * b, index, b * sizeof(double));
+            MPI_Send(message, b * (b + 1), MPI_DOUBLE, rank - step, 0, comm);
+            counts->messages++;
+            break;
+        }
+        if (rank + step < p) {
+            MPI_Recv(message, b * (b + 1), MPI_DOUBLE, rank + step, 0, comm, MPI_STATUS_IGNORE);
+            memcpy(cand + b * b, message, (size_t)b * b * sizeof(double));
+            memcpy(index + b, message + b * b, b * sizeof(double));
+            keep_winners(cand, index, 2 * b, b);
+        }
+    }
+
+    // Process 0 factors the winners, already in pivot order, without
+    // pivoting (the tournament did it), and sends L11\U11 to everyone
+    if (rank == 0) {
+        for (int d = 0; d < b; d++) {
+            if (cand[d * b + d] == 0.0)
+                continue;
+            for (int r = d + 1; r < b; r++) {
+                cand[r * b + d] /= cand[d * b + d];
+                for (int c = d + 1; c < b; c++)
+                    cand[r * b + c] -= cand[r * b + d] * cand[d * b + c];
+            }
+        }
+        memcpy(message, cand, (size_t)b * b * sizeof(double));
+        memcpy(message + b * b, index, b * sizeof(double));
+    }
+    MPI_Bcast(message, b * (b + 1), MPI_DOUBLE, 0, comm);
+    counts->collectives++;
+    counts->latency_steps += 2 * tree_depth(p);    // up the tree, then the broadcast
+
+    for (int k = 0; k < b; k++) {
+        perm[k] = (int)message[b * b + k];
+        for (int c = 0; c < b; c++)
+            U[k * b + c] = c < k ? 0.0 : message[k * b + c];
+    }
+
+    // My rows of L: pivot rows copy theirs from L11; every other row
+    // solves l U = a, one column at a time
+    double *l = malloc(b * sizeof(double));
+    for (int i = 0; i < rows_local; i++) {
+        int k = -1;
+        for (int j = 0; j < b; j++)
+            if (perm[j] == offset + i)
+                k = j;
+        for (int c = 0; c < b; c++) {
+            if (k >= 0) {
+                l[c] = c < k ? message[k * b + c] : (c == k ? 1.0 : 0.0);
+            } else {
+                double sum = A[i + c * rows_local];
+                for (int j = 0; j < c; j++)
+                    sum -= l[j] * U[j * b + c];
+                l[c] = U[c * b + c] != 0.0 ? sum / U[c * b + c] : 0.0;
+            }
+        }
+        for (int c = 0; c < b; c++)
+            A[i + c * rows_local] = l[c];
+    }
+
+    free(l);
+    free(cand);
+    free(index);
+    free(message);
+}
+
+
+/* ---------- Checking and timing ---------- */
+
+// max |A - L U| / max |A| over the whole panel, and max |L|
+void check_panel(const double *A, const double *L, const double *U, int rows_local, int b,
+                 double *residual, double *max_l, MPI_Comm comm) {
+    double local[3] = { 0.0, 0.0, 0.0 };    // error, max |A|, max |L|
+    for (int i = 0; i < rows_local; i++) {
+        for (int c = 0; c < b; c++) {
+            double lu = 0.0;
+            for (int j = 0; j <= c; j++)
+                lu += L[i + j * rows_local] * U[j * b + c];
+            local[0] = fmax(local[0], fabs(A[i + c * rows_local] - lu));
+            local[1] = fmax(local[1], fabs(A[i + c * rows_local]));
+            local[2] = fmax(local[2], fabs(L[i + c * rows_local]));
+        }
+    }
+    double global[3];
+    MPI_Allreduce(local, global, 3, MPI_DOUBLE, MPI_MAX, comm);
+    *residual = global[0] / global[1];
+    *max_l = global[2];
+}
+
+typedef void (*panel_method)(double *, int, int, int, double *, int *, comm_counts *, MPI_Comm);
+
+// Best time over reps (slowest process each time), then check the result
+void run_method(const char *name, panel_method method, const double *A, int rows_local, int b,
+                int reps, MPI_Comm comm) {
+    int rank, p;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &p);
+    double *L = malloc((size_t)rows_local * b * sizeof(double));
+    double *U = malloc((size_t)b * b * sizeof(double));
+    int *perm = malloc(b * sizeof(int));
+    comm_counts counts = { 0, 0, 0 };
+    double best = 0.0;
+
+    for (int r = 0; r < reps; r++) {
+        memcpy(L, A, (size_t)rows_local * b * sizeof(double));
+        counts = (comm_counts){ 0, 0, 0 };
+        MPI_Barrier(comm);
+        double start = MPI_Wtime();
+        method(L, rows_local, b, rank * rows_local, U, perm, &counts, comm);
+        double elapsed = MPI_Wtime() - start, slowest;
+        MPI_Allreduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, comm);
+        if (r == 0 || slowest < best)
+            best = slowest;
+    }
+
+    double residual, max_l;
+    check_panel(A, L, U, rows_local, b, &residual, &max_l, comm);
+    int messages;
+    MPI_Reduce(&counts.messages, &messages, 1, MPI_INT, MPI_SUM, 0, comm);
+    if (rank == 0) {
+        printf("%6d %-12s %10.3f %12d %10d %10d %12.2e %8.2f\n", p, name, best * 1000,
+               counts.collectives, messages, counts.latency_steps, residual, max_l);
+    }
+    free(L);
+    free(U);
+    free(perm);
+}
+
+int main(int argc, char **argv) {
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    int rows_local = argc > 1 ? atoi(argv[1]) : 10000;
+    int b = argc > 2 ? atoi(argv[2]) : 32;
+    int reps = argc > 3 ? atoi(argv[3]) : 5;
+    if (b < 1 || rows_local < b || reps < 1) {
+        if (rank == 0)
+            fprintf(stderr, "Usage: %s [rows_per_process >= b] [b >= 1] [reps >= 1]\n", argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (rank == 0) {
+        printf("Tall-skinny LU of a (%d x P) by %d panel\n", rows_local, b);
+        printf("time: best of %d, slowest process. collectives: calls per process.\n", reps);
+        printf("p2p msgs: point-to-point messages sent, all processes. latency: message\n");
+        printf("latencies on the critical path, counting log2(P) per collective.\n");
+        printf("residual: max|A - LU| / max|A|\n\n");
+        printf("%6s %-12s %10s %12s %10s %10s %12s %8s\n", "procs", "method", "time (ms)",
+               "collectives", "p2p msgs", "latency", "residual", "max |L|");
+    }
+
+    double *A = malloc((size_t)rows_local * b * sizeof(double));
+    random_panel(A, rows_local, b, rank);
+
+    // 1, 2, 4, ... processes, then all of them
+    for (int p = 1; ; p = p * 2 < size ? p * 2 : size) {
+        MPI_Comm comm;
+        MPI_Comm_split(MPI_COMM_WORLD, rank < p ? 0 : MPI_UNDEFINED, rank, &comm);
+        if (comm != MPI_COMM_NULL) {
+            run_method("by column", panel_by_columns, A, rows_local, b, reps, comm);
+            run_method("tournament", panel_tournament, A, rows_local, b, reps, comm);
+            MPI_Comm_free(&comm);
+        }
+        if (p == size)
+            break;
+    }
+
+    free(A);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,199 @@
+#!/bin/bash
+#
+# Rerun an OpenMP program under different thread placements and print a
+# table of run time for each placement and thread count.
+#
+# Usage: ./affinity_sweep.sh [-r reps] [-t "1 2 4 8"] [-m text] [-v] program args...
+#
+#   Put {T} in the arguments where the thread count goes, e.g.
+#
+#     ./affinity_sweep.sh -m "Parallel (with false sharing):" \
+#         ../falsesharing/falsesharing {T} 10000000
+#     ./affinity_sweep.sh -t "4 8 16" -m "Time:" ../rng/rng_demo_philox {T} 100000000
+#
+#   OMP_NUM_THREADS is set to the same number, for programs that read it
+#   instead.
+#
+#   -r reps   runs per configuration; the best time is reported (default 3)
+#   -t list   thread counts (default 1, 2, 4, ... up to the logical CPUs,
+#             plus the number of physical cores)
+#   -m text   take the time from the program's output: the first number
+#             after the last line containing text, in seconds. Use this
+#             when the program does more than the parallel part (serial
+#             baselines, sweeps of its own), or the table will time that
+#             too. Without -m, the whole process is timed.
+#   -v        show where the runtime put each thread (OMP_DISPLAY_AFFINITY)
+#
+# The placements:
+#
+#   unbound          OMP_PROC_BIND=false: the OS moves threads around freely
+#   close/threads    pack threads onto neighbouring hardware threads, so
+#                    SMT siblings share a core (and its L1/L2)
+#   close/cores      one thread per core, neighbouring cores first
+#   spread/cores     one thread per core, spread as far apart as possible
+#                    (across sockets first), for more total cache and
+#                    memory bandwidth
+#   spread/sockets   threads spread over sockets, free to move within one
+#
+# Which wins depends on the program: threads that share data like being
+# close, threads that each stream their own data like being spread.
+
+REPS=3
+THREADS=""
+VERBOSE=0
+MARKER=""
+
+while getopts "r:t:m:v" opt; do
+    case $opt in
+        r) REPS=$OPTARG ;;
+        t) THREADS=$OPTARG ;;
+        m) MARKER=$OPTARG ;;
+        v) VERBOSE=1 ;;
+        *) sed -n '3,25p' "$0"; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ]; then
+    sed -n '3,25p' "$0"
+    exit 1
+fi
+
+SYS=/sys/devices/system/cpu
+
+# ---------- Topology ----------
+
+LOGICAL=$(ls -d $SYS/cpu[0-9]* | wc -l)
+SOCKETS=$(cat $SYS/cpu[0-9]*/topology/physical_package_id 2>/dev/null | sort -u | wc -l)
+CORES=$(for c in $SYS/cpu[0-9]*/topology; do
+            echo "$(cat $c/physical_package_id) $(cat $c/core_id)"
+        done 2>/dev/null | sort -u | wc -l)
+[ "$SOCKETS" -gt 0 ] || SOCKETS=1
+[ "$CORES" -gt 0 ] || CORES=$LOGICAL
+
+echo "Topology"
+echo "  Sockets:           $SOCKETS"
+echo "  Physical cores:    $CORES"
+echo "  Logical CPUs:      $LOGICAL ($((LOGICAL / CORES)) per core)"
+if [ -r $SYS/cpu0/topology/thread_siblings_list ]; then
+    echo "  cpu0 SMT siblings: $(cat $SYS/cpu0/topology/thread_siblings_list)"
+fi
+
+# Each cache cpu0 sees, and which CPUs share it
+echo "  Caches seen by cpu0:"
+for idx in $SYS/cpu0/cache/index[0-9]*; do
+    [ -r $idx/level ] || continue
+    printf "    L%s %-12s %8s   shared by CPUs %s\n" "$(cat $idx/level)" "$(cat $idx/type)" \
+           "$(cat $idx/size)" "$(cat $idx/shared_cpu_list)"
+done
+echo ""
+
+if [ -z "$THREADS" ]; then
+    t=1
+    while [ $t -lt $LOGICAL ]; do
+        THREADS="$THREADS $t"
+        t=$((t * 2))
+    done
+    THREADS="$THREADS $LOGICAL"
+    if [ $CORES -ne $LOGICAL ] && ! echo " $THREADS " | grep -q " $CORES "; then
+        THREADS="$THREADS $CORES"
+    fi
+    THREADS=$(echo $THREADS | tr ' ' '\n' | sort -n | uniq | tr '\n' ' ')
+fi
+
+# ---------- Sweep ----------
+
+CONFIGS="unbound close/threads close/cores spread/cores spread/sockets"
+
+# Run the program once with the given placement and thread count; print
+# nanoseconds, or fail if the program failed or (with -m) reported no time
+run_once() {
+    local config=$1 threads=$2
+    local bind=${config%/*} places=${config#*/}
+    local args=()
+    for a in "${PROGRAM[@]}"; do
+        args+=("${a//\{T\}/$threads}")
+    done
+
+    local env_vars=(OMP_NUM_THREADS=$threads)
+    if [ "$config" = unbound ]; then
+        env_vars+=(OMP_PROC_BIND=false)
+    else
+        env_vars+=(OMP_PROC_BIND=$bind OMP_PLACES=$places)
+    fi
+    [ $VERBOSE -eq 1 ] && env_vars+=(OMP_DISPLAY_AFFINITY=true)
+
+    local start end output status
+    start=$(date +%s%N)
+    output=$(env "${env_vars[@]}" "${args[@]}" 2>&1)
+    status=$?
+    end=$(date +%s%N)
+    [ $VERBOSE -eq 1 ] && grep -i "affinity" <<< "$output" >&2
+    [ $status -eq 0 ] || return 1
+
+    if [ -z "$MARKER" ]; then
+        echo $((end - start))
+        return 0
+    fi
+    local ns
+    ns=$(awk -v marker="$MARKER" '
+        index($0, marker) { line = substr($0, index($0, marker) + length(marker)) }
+        END {
+            if (match(line, /[0-9]*\.?[0-9]+([eE][-+]?[0-9]+)?/))
+                printf "%.0f\n", substr(line, RSTART, RLENGTH) * 1e9
+        }' <<< "$output")
+    [ -n "$ns" ] || return 1
+    echo "$ns"
+}
+
+PROGRAM=("$@")
+echo "Program: ${PROGRAM[*]}"
+if [ -n "$MARKER" ]; then
+    echo "Timing: the time reported after \"$MARKER\""
+else
+    echo "Timing: the whole process"
+fi
+echo "Best of $REPS runs, in seconds (* = fastest for that thread count)"
+echo ""
+
+declare -A TIMES
+for t in $THREADS; do
+    for config in $CONFIGS; do
+        best=""
+        for ((r = 0; r < REPS; r++)); do
+            [ $VERBOSE -eq 1 ] && [ $r -eq 0 ] && echo "--- $config, $t threads" >&2
+            time=$(run_once $config $t) || { best=failed; break; }
+            if [ -z "$best" ] || [ $time -lt $best ]; then
+                best=$time
+            fi
+        done
+        TIMES[$config,$t]=$best
+    done
+done
+
+# ---------- Table ----------
+
+printf "%-16s" "Placement"
+for t in $THREADS; do
+    printf " %9s" "$t thr"
+done
+echo ""
+
+for config in $CONFIGS; do
+    printf "%-16s" "$config"
+    for t in $THREADS; do
+        ns=${TIMES[$config,$t]}
+        if [ "$ns" = failed ]; then
+            printf " %8s " failed
+            continue
+        fi
+        mark="*"
+        for other in $CONFIGS; do
+            if [ "${TIMES[$other,$t]}" != failed ] && [ ${TIMES[$other,$t]} -lt $ns ]; then
+                mark=" "
+            fi
+        done
+        printf " %8s%s" $(awk "BEGIN { printf \"%.3f\", $ns / 1e9 }") "$mark"
+    done
+    echo ""
+done
@@ -1,9 +1,106 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <omp.h>
+#include "sharded_counter.h"
 
 #define ITERATIONS 100000000
 
+// Every counter update below goes through a volatile pointer. Without it,
+// -O2 notices that a loop of counter++ is just counter += iterations, and
+// there's nothing left to measure.
+
+// Per-thread counters packed next to each other: false sharing
+double time_packed(int num_threads, long iterations, long *total) {
+    long *counters = calloc(num_threads, sizeof(long));
+    double start = omp_get_wtime();
+    #pragma omp parallel num_threads(num_threads)
+    {
+        volatile long *mine = &counters[omp_get_thread_num()];
+        for (long i = 0; i < iterations; i++) {
+            (*mine)++;
+        }
+    }
+    double elapsed = omp_get_wtime() - start;
+    *total = 0;
+    for (int i = 0; i < num_threads; i++) {
+        *total += counters[i];
+    }
+    free(counters);
+    return elapsed;
+}
+
+// Per-thread counters, each on its own cache line
+double time_padded(int num_threads, long iterations, long *total) {
+    sharded_counter count;
+    if (sharded_counter_init(&count, num_threads) != 0) {
+        fprintf(stderr, "sharded_counter_init: out of memory for %d shards\n", num_threads);
+        exit(1);
+    }
+    double start = omp_get_wtime();
+    #pragma omp parallel num_threads(num_threads)
+    {
+        volatile long *mine = sharded_counter_shard(&count, omp_get_thread_num());
+        for (long i = 0; i < iterations; i++) {
+            (*mine)++;
+        }
+    }
+    double elapsed = omp_get_wtime() - start;
+    *total = sharded_counter_read(&count);
+    sharded_counter_free(&count);
+    return elapsed;
+}
+
+// One shared counter, updated atomically: true sharing
+double time_atomic(int num_threads, long iterations, long *total) {
+    long counter = 0;
+    double start = omp_get_wtime();
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (long i = 0; i < iterations; i++) {
+            #pragma omp atomic
+            counter++;
+        }
+    }
+    double elapsed = omp_get_wtime() - start;
+    *total = counter;
+    return elapsed;
+}
+
+// OpenMP reduction: each thread gets a private copy, combined at the end
+double time_reduction(int num_threads, long iterations, long *total) {
+    long counter = 0;
+    double start = omp_get_wtime();
+    #pragma omp parallel num_threads(num_threads) reduction(+:counter)
+    {
+        volatile long *mine = &counter;
+        for (long i = 0; i < iterations; i++) {
+            (*mine)++;
+        }
+    }
+    double elapsed = omp_get_wtime() - start;
+    *total = counter;
+    return elapsed;
+}
+
+// The same thing by hand: count in a local variable, add it in once
+double time_thread_local(int num_threads, long iterations, long *total) {
+    long counter = 0;
+    double start = omp_get_wtime();
+    #pragma omp parallel num_threads(num_threads)
+    {
+        long local = 0;
+        volatile long *mine = &local;
+        for (long i = 0; i < iterations; i++) {
+            (*mine)++;
+        }
+        #pragma omp atomic
+        counter += local;
+    }
+    double elapsed = omp_get_wtime() - start;
+    *total = counter;
+    return elapsed;
+}
+
 int main(int argc, char *argv[]) {
     int num_threads = 4;
     long iterations = ITERATIONS;
@@ -15,41 +112,54 @@ int main(int argc, char *argv[]) {
         iterations = atol(argv[2]);
     }
 
-    // Allocate array
-    long *counters = calloc(num_threads, sizeof(long));
-
     printf("Running with %d threads, %ld iterations per thread\n\n", num_threads, iterations);
 
     // Parallel version with false sharing
-    double start = omp_get_wtime();
-    #pragma omp parallel num_threads(num_threads)
-    {
-        int tid = omp_get_thread_num();
-        for (long i = 0; i < iterations; i++) {
-            counters[tid]++;
-        }
-    }
-    double time_parallel = omp_get_wtime() - start;
+    long total;
+    double time_parallel = time_packed(num_threads, iterations, &total);
 
     // Serial baseline
-    start = omp_get_wtime();
+    double start = omp_get_wtime();
     long serial_counter = 0;
+    volatile long *serial = &serial_counter;
     for (long i = 0; i < iterations * num_threads; i++) {
-        serial_counter++;
+        (*serial)++;
     }
     double time_serial = omp_get_wtime() - start;
 
-    // Verify correctness
-    long total = 0;
-    for (int i = 0; i < num_threads; i++) {
-        total += counters[i];
-    }
-
     printf("Results:\n");
     printf("  Parallel (with false sharing): %.2e seconds\n", time_parallel);
     printf("  Serial baseline:               %.2e seconds\n\n", time_serial);
 
-    free(counters);
+    // Now the fixes, as the thread count grows
+    typedef double (*counter_test)(int, long, long *);
+    const char *names[] = { "packed", "padded", "atomic", "reduction", "thread-local" };
+    counter_test tests[] = { time_packed, time_padded, time_atomic, time_reduction, time_thread_local };
+    const int num_tests = sizeof(tests) / sizeof(tests[0]);
+
+    printf("Detected cache line size: %zu bytes\n", cache_line_size());
+    printf("Seconds for each approach (%ld iterations per thread):\n\n", iterations);
+    printf("%8s", "Threads");
+    for (int t = 0; t < num_tests; t++) {
+        printf(" %13s", names[t]);
+    }
+    printf("\n");
+
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > num_threads)
+            threads = num_threads;
+
+        printf("%8d", threads);
+        for (int t = 0; t < num_tests; t++) {
+            double elapsed = tests[t](threads, iterations, &total);
+            printf(" %12.2e%s", elapsed, total == threads * iterations ? " " : "!");
+        }
+        printf("\n");
+
+        if (threads == num_threads)
+            break;
+    }
+    printf("\n(! = wrong total)\n");
 
     return 0;
 }
@@ -0,0 +1,92 @@
+#ifndef SHARDED_COUNTER_H
+#define SHARDED_COUNTER_H
+
+/*
+ * A counter split into one shard per thread, with every shard on its own
+ * cache line. This is the fix for falsesharing.c.
+ *
+ * The cache keeps memory in lines (usually 64 bytes, but not always - some
+ * ARM and POWER chips use 128). When two threads write to different longs
+ * in the same line, the line ping-pongs between their cores even though
+ * they never touch the same variable. Padding each shard out to a full
+ * line, and aligning the array to a line boundary, gives each thread a
+ * line to itself.
+ *
+ * We ask the OS for the line size at run time rather than hard-coding 64.
+ *
+ * Usage from OpenMP:
+ *
+ *     sharded_counter count;
+ *     sharded_counter_init(&count, omp_get_max_threads());
+ *     #pragma omp parallel
+ *     {
+ *         int tid = omp_get_thread_num();
+ *         ...
+ *         sharded_counter_add(&count, tid, 1);
+ *     }
+ *     long total = sharded_counter_read(&count);   // one pass over the shards
+ *     sharded_counter_free(&count);
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+    char *slots;        // num_shards lines of `stride` bytes each
+    size_t stride;      // bytes between shards: the cache line size
+    int num_shards;
+} sharded_counter;
+
+// Cache line size in bytes: sysconf, then sysfs, then a reasonable guess
+static inline size_t cache_line_size(void) {
+    long size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    if (size > 0)
+        return size;
+
+    FILE *f = fopen("/sys/devices/system/cpu/cpu0/cache/index0/coherency_line_size", "r");
+    if (f) {
+        if (fscanf(f, "%ld", &size) != 1)
+            size = 0;
+        fclose(f);
+    }
+    return size > 0 ? size : 64;
+}
+
+// Returns 0 on success, -1 if the allocation fails
+static inline int sharded_counter_init(sharded_counter *c, int num_shards) {
+    c->stride = cache_line_size();
+    if (c->stride < sizeof(long))
+        c->stride = sizeof(long);
+    c->num_shards = num_shards;
+    if (posix_memalign((void **)&c->slots, c->stride, c->stride * num_shards) != 0)
+        return -1;
+    for (int i = 0; i < num_shards; i++)
+        *(long *)(c->slots + i * c->stride) = 0;
+    return 0;
+}
+
+// Pointer to a shard, for hot loops that want to hold on to it
+static inline long *sharded_counter_shard(sharded_counter *c, int shard) {
+    return (long *)(c->slots + shard * c->stride);
+}
+
+static inline void sharded_counter_add(sharded_counter *c, int shard, long amount) {
+    *sharded_counter_shard(c, shard) += amount;
+}
+
+// Total over all shards. Not synchronized: call it after the parallel
+// region, or accept a value that may miss in-flight updates.
+static inline long sharded_counter_read(sharded_counter *c) {
+    long total = 0;
+    for (int i = 0; i < c->num_shards; i++)
+        total += *sharded_counter_shard(c, i);
+    return total;
+}
+
+static inline void sharded_counter_free(sharded_counter *c) {
+    free(c->slots);
+    c->slots = NULL;
+}
+
+#endif
@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <omp.h>
+#include "scan.h"
+
+/*
+ * fib.c shows that "#pragma omp parallel for" breaks a loop-carried
+ * dependency. This program computes three linear recurrences correctly in
+ * parallel, by treating them as scans (see scan.h), and compares each with
+ * its serial loop:
+ *
+ *   1. Fibonacci mod p          f[i] = f[i-1] + f[i-2]  (mod 1e9+7)
+ *   2. First-order filter       x[i] = a * x[i-1] + b[i]
+ *   3. Damped oscillator        y[i] = c1 * y[i-1] + c2 * y[i-2]
+ *
+ * The modular version must match exactly. The floating point versions
+ * add things up in a different order than the serial loop, so we report
+ * the largest difference relative to the largest value instead. That
+ * difference grows with how lopsided the step matrix is: for the
+ * oscillator, roughly like 1/theta^2, so slow oscillations (small theta)
+ * lose more digits to the matrix powers than fast ones.
+ */
+
+#define DEFAULT_N 100000000L
+#define MOD 1000000007ULL
+
+
+/* ---------- 1. Fibonacci mod p: 2x2 matrices mod p ---------- */
+
+typedef struct {
+    uint64_t m[2][2];
+} mat2_mod;
+
+static inline mat2_mod mat2_mod_mul(mat2_mod x, mat2_mod y) {
+    mat2_mod r;
+    for (int i = 0; i < 2; i++)
+        for (int j = 0; j < 2; j++)
+            r.m[i][j] = (x.m[i][0] * y.m[0][j] + x.m[i][1] * y.m[1][j]) % MOD;
+    return r;
+}
+
+static inline mat2_mod mat2_mod_pow(mat2_mod x, long k) {
+    mat2_mod r = {{ { 1, 0 }, { 0, 1 } }};
+    while (k > 0) {
+        if (k & 1)
+            r = mat2_mod_mul(r, x);
+        x = mat2_mod_mul(x, x);
+        k >>= 1;
+    }
+    return r;
+}
+
+typedef struct {
+    uint32_t *f;
+} fib_ctx;
+
+// Every step is the same matrix, so a block of len steps is just M^len
+static inline mat2_mod fib_reduce(const fib_ctx *ctx, long lo, long hi) {
+    mat2_mod step = {{ { 1, 1 }, { 1, 0 } }};
+    return mat2_mod_pow(step, hi - lo);
+}
+
+// "a then b" for column-vector states is b * a
+static inline mat2_mod fib_combine(mat2_mod a, mat2_mod b) {
+    return mat2_mod_mul(b, a);
+}
+
+// State (f[i], f[i-1]) starts at (f[0], f[-1]) = (0, 1)
+static inline void fib_finish(fib_ctx *ctx, long lo, long hi, const mat2_mod *prefix) {
+    uint64_t cur = 0, prev = 1;
+    if (prefix) {
+        cur = prefix->m[0][1];    // prefix * (0, 1)
+        prev = prefix->m[1][1];
+    }
+    for (long i = lo; i < hi; i++) {
+        ctx->f[i] = cur;
+        uint64_t next = cur + prev;
+        if (next >= MOD)
+            next -= MOD;
+        prev = cur;
+        cur = next;
+    }
+}
+
+DEFINE_PARALLEL_SCAN(fib_scan, mat2_mod, fib_ctx, fib_reduce, fib_combine, fib_finish)
+
+void fib_serial(uint32_t *f, long n) {
+    f[0] = 0;
+    f[1] = 1;
+    for (long i = 2; i < n; i++) {
+        uint64_t next = (uint64_t)f[i-1] + f[i-2];
+        f[i] = next >= MOD ? next - MOD : next;
+    }
+}
+
+
+/* ---------- 2. First-order filter: affine maps x -> A*x + B ---------- */
+
+typedef struct {
+    double A, B;
+} affine;
+
+typedef struct {
+    double a;
+    const double *b;
+    double *x;
+} filter_ctx;
+
+// A block maps x to a^len * x + (the block run from x = 0)
+static inline affine filter_reduce(const filter_ctx *ctx, long lo, long hi) {
+    double B = 0.0;
+    for (long i = lo; i < hi; i++)
+        B = ctx->a * B + ctx->b[i];
+    return (affine){ pow(ctx->a, hi - lo), B };
+}
+
+static inline affine filter_combine(affine p, affine q) {
+    return (affine){ q.A * p.A, q.A * p.B + q.B };
+}
+
+// x[-1] = 0, so the state entering a block is just prefix.B
+static inline void filter_finish(filter_ctx *ctx, long lo, long hi, const affine *prefix) {
+    double x = prefix ? prefix->B : 0.0;
+    for (long i = lo; i < hi; i++) {
+        x = ctx->a * x + ctx->b[i];
+        ctx->x[i] = x;
+    }
+}
+
+DEFINE_PARALLEL_SCAN(filter_scan, affine, filter_ctx, filter_reduce, filter_combine, filter_finish)
+
+void filter_serial(double a, const double *b, double *x, long n) {
+    x[0] = b[0];
+    for (long i = 1; i < n; i++) {
+        x[i] = a * x[i-1] + b[i];
+    }
+}
+
+
+/* ---------- 3. Damped oscillator: 2x2 matrices of doubles ---------- */
+
+typedef struct {
+    double m[2][2];
+} mat2;
+
+static inline mat2 mat2_mul(mat2 x, mat2 y) {
+    mat2 r;
+    for (int i = 0; i < 2; i++)
+        for (int j = 0; j < 2; j++)
+            r.m[i][j] = x.m[i][0] * y.m[0][j] + x.m[i][1] * y.m[1][j];
+    return r;
+}
+
+static inline mat2 mat2_pow(mat2 x, long k) {
+    mat2 r = {{ { 1, 0 }, { 0, 1 } }};
+    while (k > 0) {
+        if (k & 1)
+            r = mat2_mul(r, x);
+        x = mat2_mul(x, x);
+        k >>= 1;
+    }
+    return r;
+}
+
+typedef struct {
+    double c1, c2;
+    double y0, y1;   // y[0] and y[1]
+    double *y;
+} osc_ctx;
+
+static inline mat2 osc_reduce(const osc_ctx *ctx, long lo, long hi) {
+    mat2 step = {{ { ctx->c1, ctx->c2 }, { 1, 0 } }};
+    return mat2_pow(step, hi - lo);
+}
+
+static inline mat2 osc_combine(mat2 a, mat2 b) {
+    return mat2_mul(b, a);
+}
+
+// State (y[i], y[i-1]) starts at (y[0], y[-1]), where y[-1] is whatever
+// makes y[1] come out right: y[1] = c1*y[0] + c2*y[-1]
+static inline void osc_finish(osc_ctx *ctx, long lo, long hi, const mat2 *prefix) {
+    double cur = ctx->y0;
+    double prev = (ctx->y1 - ctx->c1 * ctx->y0) / ctx->c2;
+    if (prefix) {
+        double c = prefix->m[0][0] * cur + prefix->m[0][1] * prev;
+        double p = prefix->m[1][0] * cur + prefix->m[1][1] * prev;
+        cur = c;
+        prev = p;
+    }
+    for (long i = lo; i < hi; i++) {
+        ctx->y[i] = cur;
+        double next = ctx->c1 * cur + ctx->c2 * prev;
+        prev = cur;
+        cur = next;
+    }
+}
+
+DEFINE_PARALLEL_SCAN(osc_scan, mat2, osc_ctx, osc_reduce, osc_combine, osc_finish)
+
+void osc_serial(double c1, double c2, double *y, long n) {
+    y[0] = 1.0;
+    y[1] = c1;
+    for (long i = 2; i < n; i++) {
+        y[i] = c1 * y[i-1] + c2 * y[i-2];
+    }
+}
+
+
+/* ---------- Driver ---------- */
+
+// Largest |x - y|, relative to the largest |x|
+double relative_error(const double *x, const double *y, long n) {
+    double max_diff = 0.0, max_val = 0.0;
+    for (long i = 0; i < n; i++) {
+        if (fabs(x[i] - y[i]) > max_diff) max_diff = fabs(x[i] - y[i]);
+        if (fabs(x[i]) > max_val) max_val = fabs(x[i]);
+    }
+    return max_val > 0.0 ? max_diff / max_val : max_diff;
+}
+
+void report(const char *name, double serial_time, double scan_time, int num_threads,
+            const char *check) {
+    printf("%-22s %10.4f %10.4f %8.2fx %7.1f%%   %s\n", name, serial_time, scan_time,
+           serial_time / scan_time, 100.0 * serial_time / (scan_time * num_threads), check);
+}
+
+int main(int argc, char *argv[]) {
+    int num_threads = 4;
+    long n = DEFAULT_N;
+
+    if (argc > 1) {
+        num_threads = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        n = atol(argv[2]);
+    }
+    if (num_threads < 1 || n < 2) {
+        printf("Usage: %s [num_threads >= 1] [n >= 2]\n", argv[0]);
+        return 1;
+    }
+
+    printf("Linear recurrences as parallel scans: n = %ld, %d threads\n\n", n, num_threads);
+    printf("%-22s %10s %10s %9s %8s   %s\n", "Recurrence", "Serial (s)", "Scan (s)",
+           "Speedup", "Effic.", "Check");
+
+    double start;
+    char check[64];
+
+    // 1. Fibonacci mod p
+    {
+        uint32_t *serial = malloc(n * sizeof(uint32_t));
+        uint32_t *parallel = malloc(n * sizeof(uint32_t));
+
+        start = omp_get_wtime();
+        fib_serial(serial, n);
+        double serial_time = omp_get_wtime() - start;
+
+        fib_ctx ctx = { parallel };
+        start = omp_get_wtime();
+        fib_scan(&ctx, n, num_threads);
+        double scan_time = omp_get_wtime() - start;
+
+        long mismatches = 0;
+        for (long i = 0; i < n; i++) {
+            if (serial[i] != parallel[i])
+                mismatches++;
+        }
+        snprintf(check, sizeof(check), "%ld mismatches", mismatches);
+        report("fib mod 1e9+7", serial_time, scan_time, num_threads, check);
+
+        free(serial);
+        free(parallel);
+    }
+
+    // 2. First-order filter, with a made-up input signal
+    {
+        double a = 0.9999;
+        double *b = malloc(n * sizeof(double));
+        double *serial = malloc(n * sizeof(double));
+        double *parallel = malloc(n * sizeof(double));
+        for (long i = 0; i < n; i++) {
+            b[i] = (double)((i * 2654435761UL) % 1000) / 1000.0 - 0.5;
+        }
+
+        start = omp_get_wtime();
+        filter_serial(a, b, serial, n);
+        double serial_time = omp_get_wtime() - start;
+
+        filter_ctx ctx = { a, b, parallel };
+        start = omp_get_wtime();
+        filter_scan(&ctx, n, num_threads);
+        double scan_time = omp_get_wtime() - start;
+
+        snprintf(check, sizeof(check), "relative error %.1e", relative_error(serial, parallel, n));
+        report("x = a*x + b[i]", serial_time, scan_time, num_threads, check);
+
+        free(b);
+        free(serial);
+        free(parallel);
+    }
+
+    // 3. Damped oscillator: decays by about 10% over 1e8 steps
+    {
+        double r = 1.0 - 1e-9, theta = 0.1;
+        double c1 = 2.0 * r * cos(theta), c2 = -r * r;
+        double *serial = malloc(n * sizeof(double));
+        double *parallel = malloc(n * sizeof(double));
+
+        start = omp_get_wtime();
+        osc_serial(c1, c2, serial, n);
+        double serial_time = omp_get_wtime() - start;
+
+        osc_ctx ctx = { c1, c2, 1.0, c1, parallel };
+        start = omp_get_wtime();
+        osc_scan(&ctx, n, num_threads);
+        double scan_time = omp_get_wtime() - start;
+
+        snprintf(check, sizeof(check), "relative error %.1e", relative_error(serial, parallel, n));
+        report("y = c1*y' + c2*y''", serial_time, scan_time, num_threads, check);
+
+        free(serial);
+        free(parallel);
+    }
+
+    return 0;
+}
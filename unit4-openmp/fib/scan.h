@@ -0,0 +1,84 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+/*
+ * Blocked two-pass parallel scan ("reduce, then scan").
+ *
+ * A scan (prefix sum) computes out[i] = e[0] o e[1] o ... o e[i] for any
+ * associative operator o. It looks as serial as fib.c's loop, but
+ * associativity lets us regroup the work:
+ *
+ *   Pass 1: each thread boils its block of elements down to one value,
+ *           the "block total".
+ *   Then:   one thread scans the (num_threads) block totals, which gives
+ *           every block the combined value of everything before it.
+ *   Pass 2: each thread redoes its block, starting from that prefix.
+ *
+ * About 2n operations instead of n, but n/p of them per thread.
+ *
+ * Linear recurrences are scans in disguise. fib[i] = fib[i-1] + fib[i-2]
+ * says (fib[i], fib[i-1]) = M * (fib[i-1], fib[i-2]) with the 2x2 matrix
+ * M = [1 1; 1 0]. Matrix products are associative, so the state at the
+ * start of any block is (product of all earlier M's) * (initial state).
+ *
+ * Usage. DEFINE_PARALLEL_SCAN(name, T, Ctx, reduce_block, combine, finish_block)
+ * defines
+ *
+ *     void name(Ctx *ctx, long n, int num_threads);
+ *
+ * from three functions you supply (static inline, so they get inlined):
+ *
+ *     T    reduce_block(const Ctx *ctx, long lo, long hi)
+ *              the combined value of elements lo .. hi-1 (never empty)
+ *     T    combine(T a, T b)
+ *              a followed by b. Must be associative; need not be commutative.
+ *     void finish_block(Ctx *ctx, long lo, long hi, const T *prefix)
+ *              write outputs lo .. hi-1, given prefix = elements 0 .. lo-1
+ *              combined (NULL for the first block)
+ *
+ * Splitting the work this way lets reduce_block use a shortcut when there
+ * is one (e.g. M^len by repeated squaring when every element is the same
+ * M), and lets finish_block run the plain serial recurrence, which is
+ * cheaper than combining element by element.
+ */
+
+#include <stdlib.h>
+#include <omp.h>
+
+#define DEFINE_PARALLEL_SCAN(name, T, Ctx, reduce_block, combine, finish_block)   \
+void name(Ctx *ctx, long n, int num_threads) {                                    \
+    if (num_threads > n)                                                          \
+        num_threads = n > 0 ? n : 1;                                              \
+    T *totals = malloc(num_threads * sizeof(T));                                  \
+    T *prefix = malloc(num_threads * sizeof(T));                                  \
+                                                                                  \
+    _Pragma("omp parallel num_threads(num_threads)")                              \
+    {                                                                             \
+        int tid = omp_get_thread_num();                                           \
+        int nt = omp_get_num_threads();                                           \
+        long lo = n * tid / nt;                                                   \
+        long hi = n * (tid + 1) / nt;                                             \
+                                                                                  \
+        /* Pass 1: block totals (the last block's is never needed) */             \
+        if (tid < nt - 1)                                                         \
+            totals[tid] = reduce_block(ctx, lo, hi);                              \
+        _Pragma("omp barrier")                                                    \
+                                                                                  \
+        /* Exclusive scan of the block totals */                                  \
+        _Pragma("omp single")                                                     \
+        {                                                                         \
+            if (nt > 1)                                                           \
+                prefix[1] = totals[0];                                            \
+            for (int t = 2; t < nt; t++)                                          \
+                prefix[t] = combine(prefix[t - 1], totals[t - 1]);                \
+        }                                                                         \
+                                                                                  \
+        /* Pass 2: each block from its prefix */                                  \
+        finish_block(ctx, lo, hi, tid == 0 ? NULL : &prefix[tid]);                \
+    }                                                                             \
+                                                                                  \
+    free(totals);                                                                 \
+    free(prefix);                                                                 \
+}
+
+#endif
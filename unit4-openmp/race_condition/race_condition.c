@@ -1,10 +1,178 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
 #include <omp.h>
 
+/*
+ * Usage: race_condition <num_threads> <count_to>
+ *        race_bench bench <max_threads> <updates_per_thread>
+ *
+ * Both programs are built from this file. race_condition is unoptimized,
+ * so the racy count++ really loads and stores memory every time;
+ * race_bench is built with -O2, since the cost of each strategy only
+ * means something in optimized code.
+ *
+ * The first form shows the wrong answer from an unsynchronized count++.
+ *
+ * The second form times the correct ways to do the same thing, for 1, 2,
+ * 4, ... threads and for different amounts of "real work" between
+ * updates, and reports updates per second and scaling efficiency:
+ *
+ *   critical      #pragma omp critical around count++
+ *   atomic        #pragma omp atomic
+ *   lock          omp_set_lock / omp_unset_lock
+ *   c11-relaxed   atomic_fetch_add_explicit(..., memory_order_relaxed)
+ *   c11-acq_rel   atomic_fetch_add_explicit(..., memory_order_acq_rel)
+ *   c11-seq_cst   atomic_fetch_add (sequentially consistent)
+ *   reduction     reduction(+:count)
+ *   local         private counter per thread, added in once at the end
+ */
+
+enum {
+    SYNC_CRITICAL, SYNC_ATOMIC, SYNC_LOCK, SYNC_RELAXED, SYNC_ACQ_REL, SYNC_SEQ_CST,
+    SYNC_REDUCTION, SYNC_LOCAL, NUM_SYNCS
+};
+const char *SYNC_NAMES[NUM_SYNCS] = {
+    "critical", "atomic", "lock", "c11-relaxed", "c11-acq_rel", "c11-seq_cst",
+    "reduction", "local"
+};
+
+// Work done between updates, in steps of a dependent multiply-add chain
+const int GRANULARITIES[] = { 0, 10, 100 };
+#define NUM_GRANULARITIES (int)(sizeof(GRANULARITIES) / sizeof(GRANULARITIES[0]))
+
+volatile double work_sink;   // keeps the compiler from deleting the work
+
+static inline double do_work(int steps, double x) {
+    for (int s = 0; s < steps; s++) {
+        x = x * 0.999999 + 1e-6;
+    }
+    return x;
+}
+
+// Run one strategy. Returns elapsed seconds; the final count comes back in *count_out.
+double run_sync(int sync, int num_threads, long updates, int granularity, long *count_out) {
+    long count = 0;
+    _Atomic long atomic_count = 0;
+    omp_lock_t lock;
+    omp_init_lock(&lock);
+
+    double start = omp_get_wtime();
+
+    #pragma omp parallel num_threads(num_threads) reduction(+:count)
+    {
+        double x = omp_get_thread_num();
+        // For reduction/local: the private count lives behind a volatile
+        // pointer, so an optimizing build can't turn the loop into one big add
+        long local = 0;
+        volatile long *mine = sync == SYNC_REDUCTION ? &count : &local;
+
+        for (long i = 0; i < updates; i++) {
+            x = do_work(granularity, x);
+
+            switch (sync) {
+            case SYNC_CRITICAL:
+                #pragma omp critical
+                count_out[0]++;
+                break;
+            case SYNC_ATOMIC:
+                #pragma omp atomic
+                count_out[0]++;
+                break;
+            case SYNC_LOCK:
+                omp_set_lock(&lock);
+                count_out[0]++;
+                omp_unset_lock(&lock);
+                break;
+            case SYNC_RELAXED:
+                atomic_fetch_add_explicit(&atomic_count, 1, memory_order_relaxed);
+                break;
+            case SYNC_ACQ_REL:
+                atomic_fetch_add_explicit(&atomic_count, 1, memory_order_acq_rel);
+                break;
+            case SYNC_SEQ_CST:
+                atomic_fetch_add(&atomic_count, 1);
+                break;
+            case SYNC_REDUCTION:
+            case SYNC_LOCAL:
+                (*mine)++;
+                break;
+            }
+        }
+
+        if (sync == SYNC_LOCAL) {
+            #pragma omp atomic
+            count_out[0] += local;
+        }
+        work_sink = x;
+    }
+
+    double elapsed = omp_get_wtime() - start;
+    omp_destroy_lock(&lock);
+
+    if (sync == SYNC_REDUCTION)
+        count_out[0] = count;
+    else if (sync >= SYNC_RELAXED && sync <= SYNC_SEQ_CST)
+        count_out[0] = atomic_count;
+    return elapsed;
+}
+
+void run_benchmark(int max_threads, long updates) {
+    printf("Shared counter benchmark: %ld updates per thread, up to %d threads\n",
+           updates, max_threads);
+    printf("Rates in million updates/second (scaling efficiency vs 1 thread in parentheses)\n");
+#ifndef __OPTIMIZE__
+    printf("Warning: built without optimization; build and run ./race_bench instead\n");
+#endif
+
+    for (int g = 0; g < NUM_GRANULARITIES; g++) {
+        int granularity = GRANULARITIES[g];
+        printf("\n=== %d work steps between updates ===\n", granularity);
+        printf("%-12s", "Strategy");
+        for (int threads = 1; ; threads *= 2) {
+            if (threads > max_threads)
+                threads = max_threads;
+            printf(" %10d thr   ", threads);
+            if (threads == max_threads)
+                break;
+        }
+        printf("\n");
+
+        for (int sync = 0; sync < NUM_SYNCS; sync++) {
+            printf("%-12s", SYNC_NAMES[sync]);
+            double base_rate = 0.0;
+            for (int threads = 1; ; threads *= 2) {
+                if (threads > max_threads)
+                    threads = max_threads;
+
+                long count = 0;
+                double elapsed = run_sync(sync, threads, updates, granularity, &count);
+                double rate = threads * updates / elapsed / 1e6;
+                if (threads == 1)
+                    base_rate = rate;
+                printf(" %9.1f (%3.0f%%)%s", rate, 100.0 * rate / (threads * base_rate),
+                       count == threads * updates ? "" : "!");
+
+                if (threads == max_threads)
+                    break;
+            }
+            printf("\n");
+        }
+    }
+    printf("\n(! = wrong count)\n");
+}
+
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
+    int bench = argc == 4 && strcmp(argv[1], "bench") == 0;
+    if (bench && atoi(argv[2]) >= 1 && atol(argv[3]) >= 1) {
+        run_benchmark(atoi(argv[2]), atol(argv[3]));
+        return 0;
+    }
+
+    if (bench || argc != 3) {
         printf("Usage: %s <num_threads> <count_to>\n", argv[0]);
+        printf("       %s bench <max_threads> <updates_per_thread>\n", argv[0]);
         return 1;
     }
 
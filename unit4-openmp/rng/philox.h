@@ -0,0 +1,101 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+/*
+ * Philox4x32-10 counter-based random number generator
+ * (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC'11).
+ *
+ * A counter-based generator has no state to share between threads. The
+ * n-th random value is a pure function of (key, n): philox4x32() scrambles
+ * a 128-bit counter with a 64-bit key through 10 rounds of multiply/xor,
+ * giving 4 random 32-bit words. So:
+ *
+ *   - The key picks an independent stream. Use (seed, stream id) with a
+ *     different stream id per thread, per MPI rank, per whatever.
+ *   - The counter picks a position within the stream. Jumping ahead by a
+ *     billion numbers costs the same as jumping ahead by one.
+ *
+ * philox_stream wraps that in a familiar "give me the next number"
+ * interface. Each stream has 2^64 counter blocks of 4 words each.
+ */
+
+#include <stdint.h>
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u   // golden ratio
+#define PHILOX_W1 0xBB67AE85u   // sqrt(3) - 1
+
+typedef struct {
+    uint32_t v[4];
+} philox_ctr;
+
+typedef struct {
+    uint32_t v[2];
+} philox_key;
+
+static inline philox_ctr philox_round(philox_ctr ctr, philox_key key) {
+    uint64_t p0 = (uint64_t)PHILOX_M0 * ctr.v[0];
+    uint64_t p1 = (uint64_t)PHILOX_M1 * ctr.v[2];
+    philox_ctr out = {{
+        (uint32_t)(p1 >> 32) ^ ctr.v[1] ^ key.v[0],
+        (uint32_t)p1,
+        (uint32_t)(p0 >> 32) ^ ctr.v[3] ^ key.v[1],
+        (uint32_t)p0
+    }};
+    return out;
+}
+
+// The generator itself: 4 random words for counter ctr under key
+static inline philox_ctr philox4x32(philox_ctr ctr, philox_key key) {
+    for (int round = 0; round < 10; round++) {
+        if (round > 0) {
+            key.v[0] += PHILOX_W0;
+            key.v[1] += PHILOX_W1;
+        }
+        ctr = philox_round(ctr, key);
+    }
+    return ctr;
+}
+
+typedef struct {
+    philox_key key;
+    uint64_t block;      // which counter block we're in
+    philox_ctr out;      // the 4 words for that block
+    int used;            // how many of them we've handed out
+} philox_stream;
+
+// Position a stream. Stream id `stream` of generator `seed`, starting
+// `offset` 32-bit words in. Any thread can call this for any stream and
+// offset, and gets exactly the numbers a serial loop would have seen there.
+static inline void philox_stream_init(philox_stream *s, uint32_t seed, uint32_t stream, uint64_t offset) {
+    s->key.v[0] = seed;
+    s->key.v[1] = stream;
+    s->block = offset / 4;
+    philox_ctr ctr = {{ (uint32_t)s->block, (uint32_t)(s->block >> 32), 0, 0 }};
+    s->out = philox4x32(ctr, s->key);
+    s->used = offset % 4;
+}
+
+static inline uint32_t philox_next_u32(philox_stream *s) {
+    if (s->used == 4) {
+        s->block++;
+        philox_ctr ctr = {{ (uint32_t)s->block, (uint32_t)(s->block >> 32), 0, 0 }};
+        s->out = philox4x32(ctr, s->key);
+        s->used = 0;
+    }
+    return s->out.v[s->used++];
+}
+
+// Uniform double in [0, 1) from two random words (53 random bits)
+static inline double philox_to_double(uint32_t hi, uint32_t lo) {
+    return (double)((((uint64_t)hi << 32) | lo) >> 11) * 0x1.0p-53;
+}
+
+static inline double philox_next_double(philox_stream *s) {
+    uint32_t hi = philox_next_u32(s);
+    uint32_t lo = philox_next_u32(s);
+    return philox_to_double(hi, lo);
+}
+
+#endif
@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+#include "philox.h"
+
+/*
+ * rng_demo_safe.c gives each thread its own rand_r() state, seeded from
+ * serial rand(). That's thread-safe, but the answer changes with the
+ * number of threads, and nobody knows whether the per-thread streams
+ * overlap.
+ *
+ * Here every sample i gets the i-th number of ONE logical Philox stream,
+ * no matter which thread computes it. The samples are split into fixed
+ * blocks, each block jumps straight to its position in the stream, and
+ * the block sums are added up in block order at the end. Same blocks,
+ * same order, same bits - for 1 thread or 64.
+ *
+ * (For several independent streams, e.g. one per MPI rank, give each one
+ * its own stream id in philox_stream_init.)
+ */
+
+#define SEED 42
+#define BLOCK_SIZE 65536   // samples per block: fixed, NOT tied to thread count
+
+// Sum total_samples uniforms on [-1, 1) using num_threads threads
+double philox_sum(long total_samples, int num_threads) {
+    long num_blocks = (total_samples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    double *block_sums = malloc(num_blocks * sizeof(double));
+
+    #pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (long b = 0; b < num_blocks; b++) {
+        long first = b * BLOCK_SIZE;
+        long last = first + BLOCK_SIZE < total_samples ? first + BLOCK_SIZE : total_samples;
+
+        // Jump ahead to sample `first` (each double uses 2 words)
+        philox_stream stream;
+        philox_stream_init(&stream, SEED, 0, 2 * first);
+
+        double local_sum = 0.0;
+        for (long i = first; i < last; i++) {
+            local_sum += 2.0 * philox_next_double(&stream) - 1.0;   // Map to [-1, 1)
+        }
+        block_sums[b] = local_sum;
+    }
+
+    // Combine in a fixed order, so rounding is the same every time
+    double sum = 0.0;
+    for (long b = 0; b < num_blocks; b++) {
+        sum += block_sums[b];
+    }
+
+    free(block_sums);
+    return sum;
+}
+
+// Known-answer tests from the Random123 distribution
+int philox_self_test(void) {
+    philox_ctr zero_ctr = {{ 0, 0, 0, 0 }};
+    philox_key zero_key = {{ 0, 0 }};
+    philox_ctr ones_ctr = {{ 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu }};
+    philox_key ones_key = {{ 0xffffffffu, 0xffffffffu }};
+    philox_ctr expect_zero = {{ 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u }};
+    philox_ctr expect_ones = {{ 0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu }};
+
+    philox_ctr a = philox4x32(zero_ctr, zero_key);
+    philox_ctr b = philox4x32(ones_ctr, ones_key);
+    return memcmp(&a, &expect_zero, sizeof(a)) == 0 && memcmp(&b, &expect_ones, sizeof(b)) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        printf("Usage: %s <num_threads> <total_samples>\n", argv[0]);
+        return 1;
+    }
+
+    int num_threads = atoi(argv[1]);
+    long total_samples = atol(argv[2]);
+
+    printf("=== Counter-Based Philox Demo ===\n");
+    printf("Threads: %d, Total samples: %ld (block size %d)\n\n",
+           num_threads, total_samples, BLOCK_SIZE);
+
+    printf("Philox4x32-10 known-answer test: %s\n\n", philox_self_test() ? "PASS" : "FAIL");
+
+    // Serial run: the reference answer
+    printf("--- Serial (1 thread) ---\n");
+    double start_time = omp_get_wtime();
+    double serial_sum = philox_sum(total_samples, 1);
+    double serial_time = omp_get_wtime() - start_time;
+    printf("Sum:  %.17g\n", serial_sum);
+    printf("Time: %.6f seconds\n\n", serial_time);
+
+    // Parallel run: must match to the last bit
+    printf("--- Parallel (%d threads) ---\n", num_threads);
+    start_time = omp_get_wtime();
+    double parallel_sum = philox_sum(total_samples, num_threads);
+    double parallel_time = omp_get_wtime() - start_time;
+    printf("Sum:  %.17g\n", parallel_sum);
+    printf("Time: %.6f seconds\n", parallel_time);
+    printf("Bitwise identical to serial: %s\n\n",
+           memcmp(&serial_sum, &parallel_sum, sizeof(double)) == 0 ? "YES" : "NO");
+
+    double average = parallel_sum / total_samples;
+    double std_error = sqrt((1.0 / 3.0) / total_samples);
+    printf("Expected average: 0.0 (uniform distribution on [-1, 1])\n");
+    printf("Actual average:   %.6f\n", average);
+    printf("Z-score:          %.2f (|z| > 3 suggests non-random behavior)\n\n", average / std_error);
+
+    // Serial rand_r() for comparison, as in rng_demo_safe.c
+    printf("--- Serial Comparison (rand_r()) ---\n");
+    unsigned int serial_seed = SEED;
+    double rand_r_sum = 0.0;
+    start_time = omp_get_wtime();
+    for (long i = 0; i < total_samples; i++) {
+        rand_r_sum += 2.0 * rand_r(&serial_seed) / RAND_MAX - 1.0;
+    }
+    double rand_r_time = omp_get_wtime() - start_time;
+    printf("Serial time with rand_r(): %.6f seconds (average %.6f)\n\n",
+           rand_r_time, rand_r_sum / total_samples);
+
+    printf("--- Throughput ---\n");
+    printf("rand_r(), 1 thread:        %8.1f million samples/second\n",
+           total_samples / rand_r_time / 1e6);
+    printf("Philox, 1 thread:          %8.1f million samples/second\n",
+           total_samples / serial_time / 1e6);
+    printf("Philox, %2d threads:        %8.1f million samples/second (%.1f per thread)\n",
+           num_threads, total_samples / parallel_time / 1e6,
+           total_samples / parallel_time / 1e6 / num_threads);
+    printf("Speedup vs 1 thread:       %.2fx\n", serial_time / parallel_time);
+    printf("Efficiency:                %.1f%% (100%% = perfect scaling)\n",
+           100.0 * serial_time / (parallel_time * num_threads));
+
+    return 0;
+}
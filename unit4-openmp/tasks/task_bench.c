@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "worksteal.h"
+
+/*
+ * Recursive fib and mergesort with tasks, three ways:
+ *
+ *   omp task   #pragma omp task / taskwait, spawning above a fixed cutoff
+ *   ws cutoff  worksteal.h, same fixed cutoff
+ *   ws adapt   worksteal.h, spawning only while this thread's deque is
+ *              nearly empty. Busy threads stop splitting on their own and
+ *              idle ones make them start again, so the cutoff doesn't need
+ *              retuning for each thread count (a small floor still keeps
+ *              the checks off the tiny calls)
+ *
+ * Below the cutoff the recursion is plain serial code. Without one, every
+ * call becomes a task and the overhead swamps fib's two-instruction body;
+ * the first table measures that overhead per task.
+ *
+ * Usage: task_bench [max_threads] [fib_n] [sort_n]
+ */
+
+#define FIB_CUTOFF 20          // fib(20) is ~20k calls, a few microseconds
+#define SORT_CUTOFF 8192       // elements
+#define INSERTION_SORT 32      // below this, mergesort isn't worth it
+#define ADAPTIVE_QUEUE 2       // ws adapt: spawn while the deque has fewer than this
+#define ADAPTIVE_FIB_FLOOR 12  // ws adapt: too small to ever split (~400 calls)
+#define ADAPTIVE_SORT_FLOOR 1024
+#define OVERHEAD_FIB_N 25
+
+enum { SPAWN_ALWAYS, SPAWN_CUTOFF, SPAWN_ADAPTIVE };
+int spawn_policy;
+
+
+/* ---------- Fibonacci ---------- */
+
+long fib_serial(int n) {
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+long fib_omp(int n, int cutoff) {
+    if (n < 2)
+        return n;
+    if (n < cutoff)
+        return fib_serial(n);
+    long x, y;
+    #pragma omp task shared(x)
+    x = fib_omp(n - 1, cutoff);
+    y = fib_omp(n - 2, cutoff);
+    #pragma omp taskwait
+    return x + y;
+}
+
+typedef struct {
+    int n;
+    long result;
+} fib_args;
+
+long fib_ws(int n);
+
+void fib_task(void *p) {
+    fib_args *a = p;
+    a->result = fib_ws(a->n);
+}
+
+long fib_ws(int n) {
+    if (n < 2)
+        return n;
+    if (spawn_policy == SPAWN_CUTOFF && n < FIB_CUTOFF)
+        return fib_serial(n);
+    if (spawn_policy == SPAWN_ADAPTIVE && ws_local_queue_size() >= ADAPTIVE_QUEUE) {
+        // Enough queued for now. Keep checking on the way down, unless
+        // what's left is too small to be worth splitting later either
+        if (n < ADAPTIVE_FIB_FLOOR)
+            return fib_serial(n);
+        return fib_ws(n - 1) + fib_ws(n - 2);
+    }
+
+    fib_args a = { n - 1, 0 };
+    ws_group g = WS_GROUP_INIT;
+    ws_task t;
+    ws_spawn(&g, &t, fib_task, &a);
+    long y = fib_ws(n - 2);
+    ws_sync(&g);
+    return a.result + y;
+}
+
+
+/* ---------- Mergesort ---------- */
+
+void insertion_sort(int *a, long n) {
+    for (long i = 1; i < n; i++) {
+        int v = a[i];
+        long j = i - 1;
+        while (j >= 0 && a[j] > v) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = v;
+    }
+}
+
+// Merge the sorted halves a[0..mid) and a[mid..n), using tmp
+void merge(int *a, int *tmp, long mid, long n) {
+    long i = 0, j = mid, k = 0;
+    while (i < mid && j < n)
+        tmp[k++] = a[i] <= a[j] ? a[i++] : a[j++];
+    while (i < mid)
+        tmp[k++] = a[i++];
+    while (j < n)
+        tmp[k++] = a[j++];
+    memcpy(a, tmp, n * sizeof(int));
+}
+
+void msort_serial(int *a, int *tmp, long n) {
+    if (n < INSERTION_SORT) {
+        insertion_sort(a, n);
+        return;
+    }
+    long mid = n / 2;
+    msort_serial(a, tmp, mid);
+    msort_serial(a + mid, tmp + mid, n - mid);
+    merge(a, tmp, mid, n);
+}
+
+void msort_omp(int *a, int *tmp, long n) {
+    if (n < SORT_CUTOFF) {
+        msort_serial(a, tmp, n);
+        return;
+    }
+    long mid = n / 2;
+    #pragma omp task
+    msort_omp(a, tmp, mid);
+    msort_omp(a + mid, tmp + mid, n - mid);
+    #pragma omp taskwait
+    merge(a, tmp, mid, n);
+}
+
+typedef struct {
+    int *a, *tmp;
+    long n;
+} sort_args;
+
+void msort_ws(int *a, int *tmp, long n);
+
+void msort_task(void *p) {
+    sort_args *s = p;
+    msort_ws(s->a, s->tmp, s->n);
+}
+
+void msort_ws(int *a, int *tmp, long n) {
+    if (n < INSERTION_SORT || (spawn_policy == SPAWN_CUTOFF && n < SORT_CUTOFF)
+        || (spawn_policy == SPAWN_ADAPTIVE && n < ADAPTIVE_SORT_FLOOR
+            && ws_local_queue_size() >= ADAPTIVE_QUEUE)) {
+        msort_serial(a, tmp, n);
+        return;
+    }
+    long mid = n / 2;
+    if (spawn_policy == SPAWN_ADAPTIVE && ws_local_queue_size() >= ADAPTIVE_QUEUE) {
+        msort_ws(a, tmp, mid);
+        msort_ws(a + mid, tmp + mid, n - mid);
+    } else {
+        sort_args s = { a, tmp, mid };
+        ws_group g = WS_GROUP_INIT;
+        ws_task t;
+        ws_spawn(&g, &t, msort_task, &s);
+        msort_ws(a + mid, tmp + mid, n - mid);
+        ws_sync(&g);
+    }
+    merge(a, tmp, mid, n);
+}
+
+
+/* ---------- Driver ---------- */
+
+// Each benchmark runs one of these with a thread count; returns seconds.
+// Starting and stopping the thread pools isn't timed. For the omp task
+// version an empty parallel region makes libgomp create its threads
+// here, so the timed region reuses them instead of paying for the spawn.
+void start_ws_pool(int variant, int threads) {
+    if (variant == 1) {
+        #pragma omp parallel num_threads(threads)
+        { }
+    } else if (variant >= 2) {
+        spawn_policy = variant == 2 ? SPAWN_CUTOFF : SPAWN_ADAPTIVE;
+        ws_init(threads);
+    }
+}
+
+void stop_ws_pool(int variant) {
+    if (variant >= 2)
+        ws_shutdown();
+}
+
+double time_fib(int variant, int threads, int n, long *result) {
+    start_ws_pool(variant, threads);
+    double start = omp_get_wtime();
+    if (variant == 0) {
+        *result = fib_serial(n);
+    } else if (variant == 1) {
+        #pragma omp parallel num_threads(threads)
+        #pragma omp single
+        *result = fib_omp(n, FIB_CUTOFF);
+    } else {
+        *result = fib_ws(n);
+    }
+    double elapsed = omp_get_wtime() - start;
+    stop_ws_pool(variant);
+    return elapsed;
+}
+
+double time_sort(int variant, int threads, const int *input, int *a, int *tmp, long n) {
+    memcpy(a, input, n * sizeof(int));
+    start_ws_pool(variant, threads);
+    double start = omp_get_wtime();
+    if (variant == 0) {
+        msort_serial(a, tmp, n);
+    } else if (variant == 1) {
+        #pragma omp parallel num_threads(threads)
+        #pragma omp single
+        msort_omp(a, tmp, n);
+    } else {
+        msort_ws(a, tmp, n);
+    }
+    double elapsed = omp_get_wtime() - start;
+    stop_ws_pool(variant);
+    return elapsed;
+}
+
+const char *VARIANTS[] = { "serial", "omp task", "ws cutoff", "ws adapt" };
+#define NUM_VARIANTS 4
+
+void print_header(void) {
+    printf("%8s", "Threads");
+    for (int v = 1; v < NUM_VARIANTS; v++)
+        printf(" %20s", VARIANTS[v]);
+    printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+    int max_threads = omp_get_max_threads();
+    int fib_n = 40;
+    long sort_n = 10000000;
+
+    if (argc > 1) {
+        max_threads = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        fib_n = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        sort_n = atol(argv[3]);
+    }
+
+    // 1. Overhead per task: every call spawns, one thread
+    {
+        int n = OVERHEAD_FIB_N;
+        long tasks = fib_serial(n + 1) - 1;   // calls with n >= 2
+        long r_serial, r_omp, r_ws;
+
+        double start = omp_get_wtime();
+        r_serial = fib_serial(n);
+        double t_serial = omp_get_wtime() - start;
+
+        start = omp_get_wtime();
+        #pragma omp parallel num_threads(1)
+        #pragma omp single
+        r_omp = fib_omp(n, 0);
+        double t_omp = omp_get_wtime() - start;
+
+        spawn_policy = SPAWN_ALWAYS;
+        ws_init(1);
+        start = omp_get_wtime();
+        r_ws = fib_ws(n);
+        double t_ws = omp_get_wtime() - start;
+        ws_shutdown();
+
+        printf("Overhead per task: fib(%d) with every call a task (%ld tasks), 1 thread\n",
+               n, tasks);
+        printf("  omp task:  %7.1f ns/task%s\n", 1e9 * (t_omp - t_serial) / tasks,
+               r_omp == r_serial ? "" : "  WRONG RESULT");
+        printf("  ws spawn:  %7.1f ns/task%s\n\n", 1e9 * (t_ws - t_serial) / tasks,
+               r_ws == r_serial ? "" : "  WRONG RESULT");
+    }
+
+    // 2. fib(n) with cutoffs
+    {
+        long expected;
+        double t_serial = time_fib(0, 1, fib_n, &expected);
+        printf("fib(%d) = %ld, serial %.3f s. Seconds (speedup) for each version:\n",
+               fib_n, expected, t_serial);
+        print_header();
+        for (int threads = 1; ; threads *= 2) {
+            if (threads > max_threads)
+                threads = max_threads;
+            printf("%8d", threads);
+            for (int v = 1; v < NUM_VARIANTS; v++) {
+                long result;
+                double t = time_fib(v, threads, fib_n, &result);
+                printf("   %8.3f (%5.2fx)%s", t, t_serial / t, result == expected ? " " : "!");
+            }
+            printf("\n");
+            if (threads == max_threads)
+                break;
+        }
+        printf("\n");
+    }
+
+    // 3. Mergesort
+    {
+        int *input = malloc(sort_n * sizeof(int));
+        int *expected = malloc(sort_n * sizeof(int));
+        int *a = malloc(sort_n * sizeof(int));
+        int *tmp = malloc(sort_n * sizeof(int));
+        unsigned seed = 12345;
+        for (long i = 0; i < sort_n; i++) {
+            input[i] = rand_r(&seed);
+        }
+
+        double t_serial = time_sort(0, 1, input, expected, tmp, sort_n);
+        printf("Mergesort of %ld ints, serial %.3f s. Seconds (speedup) for each version:\n",
+               sort_n, t_serial);
+        print_header();
+        for (int threads = 1; ; threads *= 2) {
+            if (threads > max_threads)
+                threads = max_threads;
+            printf("%8d", threads);
+            for (int v = 1; v < NUM_VARIANTS; v++) {
+                double t = time_sort(v, threads, input, a, tmp, sort_n);
+                int ok = memcmp(a, expected, sort_n * sizeof(int)) == 0;
+                printf("   %8.3f (%5.2fx)%s", t, t_serial / t, ok ? " " : "!");
+            }
+            printf("\n");
+            if (threads == max_threads)
+                break;
+        }
+        printf("\n(! = wrong result)\n");
+
+        free(input);
+        free(expected);
+        free(a);
+        free(tmp);
+    }
+
+    return 0;
+}
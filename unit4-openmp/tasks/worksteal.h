@@ -0,0 +1,237 @@
+#ifndef WORKSTEAL_H
+#define WORKSTEAL_H
+
+/*
+ * A small work-stealing task scheduler, for recursive divide and conquer.
+ *
+ * Each worker thread owns a double-ended queue (a Chase-Lev deque) of
+ * tasks it has spawned but not yet run:
+ *
+ *   - The owner pushes and pops at the bottom, like a stack. No locks,
+ *     and in the common case no atomic read-modify-write either.
+ *   - An idle worker picks a random victim and steals from the top. The
+ *     top holds the oldest task, which in a recursion is the biggest one,
+ *     so one steal moves a lot of work.
+ *
+ * Only the last remaining task is contended: then the owner and thieves
+ * race with a compare-and-swap on `top`.
+ *
+ * Usage (fib as the example):
+ *
+ *     long fib(int n) {
+ *         if (n < 2) return n;
+ *         fib_args a = { n - 1 };
+ *         ws_group g = WS_GROUP_INIT;
+ *         ws_task t;
+ *         ws_spawn(&g, &t, fib_task, &a);   // someone may steal this...
+ *         long y = fib(n - 2);              // ...while we do this
+ *         ws_sync(&g);                      // wait for everything spawned into g
+ *         return a.result + y;
+ *     }
+ *
+ *     ws_init(num_threads);   // the calling thread becomes worker 0
+ *     long r = fib(40);
+ *     ws_shutdown();
+ *
+ * Tasks and their arguments live in the spawner's stack frame, which is
+ * safe because ws_sync doesn't return until they have all finished. While
+ * it waits, ws_sync runs other tasks instead of spinning.
+ *
+ * Simplification: the deque has a fixed size. If it fills up, ws_spawn
+ * just runs the task immediately.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define WS_DEQUE_SIZE 4096   // power of two
+#define WS_MAX_WORKERS 256
+
+typedef struct {
+    atomic_long pending;   // spawned tasks that haven't finished yet
+} ws_group;
+
+#define WS_GROUP_INIT { 0 }
+
+typedef struct {
+    void (*fn)(void *arg);
+    void *arg;
+    ws_group *group;
+} ws_task;
+
+// top and bottom on separate cache lines: thieves write one, the owner the other
+typedef struct {
+    _Alignas(64) atomic_long top;
+    _Alignas(64) atomic_long bottom;
+    _Atomic(ws_task *) tasks[WS_DEQUE_SIZE];
+    unsigned rng;          // for picking victims
+    int id;
+} ws_worker;
+
+static struct {
+    ws_worker *workers;
+    int num_workers;
+    pthread_t threads[WS_MAX_WORKERS];
+    atomic_int stop;
+} ws_rt;
+
+static __thread ws_worker *ws_self;   // this thread's worker
+
+
+/* ---------- The deque (Le, Pop, Cohen & Zappa Nardelli, PPoPP 2013) ---------- */
+
+// Owner only. Returns 0 if the deque is full.
+static inline int ws_push(ws_worker *w, ws_task *t) {
+    long b = atomic_load_explicit(&w->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&w->top, memory_order_acquire);
+    if (b - top >= WS_DEQUE_SIZE)
+        return 0;
+    atomic_store_explicit(&w->tasks[b & (WS_DEQUE_SIZE - 1)], t, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+    return 1;
+}
+
+// Owner only: newest task, or NULL
+static inline ws_task *ws_pop(ws_worker *w) {
+    long b = atomic_load_explicit(&w->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&w->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&w->top, memory_order_relaxed);
+
+    if (top > b) {
+        // Empty
+        atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+    ws_task *t = atomic_load_explicit(&w->tasks[b & (WS_DEQUE_SIZE - 1)], memory_order_relaxed);
+    if (top == b) {
+        // Last task: race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&w->top, &top, top + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed))
+            t = NULL;
+        atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+    }
+    return t;
+}
+
+// Any thread: oldest task, or NULL if empty or another thief got it first
+static inline ws_task *ws_steal(ws_worker *w) {
+    long top = atomic_load_explicit(&w->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&w->bottom, memory_order_acquire);
+    if (top >= b)
+        return NULL;
+    ws_task *t = atomic_load_explicit(&w->tasks[top & (WS_DEQUE_SIZE - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&w->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+        return NULL;
+    return t;
+}
+
+// Tasks waiting in this worker's deque (a hint: thieves may be taking them)
+static inline long ws_local_queue_size(void) {
+    return atomic_load_explicit(&ws_self->bottom, memory_order_relaxed)
+         - atomic_load_explicit(&ws_self->top, memory_order_relaxed);
+}
+
+
+/* ---------- Scheduling ---------- */
+
+static inline void ws_execute(ws_task *t) {
+    ws_group *g = t->group;   // t may be gone once pending drops
+    t->fn(t->arg);
+    atomic_fetch_sub_explicit(&g->pending, 1, memory_order_release);
+}
+
+// Try one random victim
+static inline ws_task *ws_steal_random(ws_worker *self) {
+    if (ws_rt.num_workers < 2)
+        return NULL;
+    self->rng ^= self->rng << 13;
+    self->rng ^= self->rng >> 17;
+    self->rng ^= self->rng << 5;
+    int victim = self->rng % (ws_rt.num_workers - 1);
+    if (victim >= self->id)
+        victim++;   // anyone but ourselves
+    return ws_steal(&ws_rt.workers[victim]);
+}
+
+static inline void ws_spawn(ws_group *g, ws_task *t, void (*fn)(void *), void *arg) {
+    t->fn = fn;
+    t->arg = arg;
+    t->group = g;
+    atomic_fetch_add_explicit(&g->pending, 1, memory_order_relaxed);
+    if (!ws_push(ws_self, t))
+        ws_execute(t);
+}
+
+// Wait for every task spawned into g, running tasks (ours first) meanwhile
+static inline void ws_sync(ws_group *g) {
+    while (atomic_load_explicit(&g->pending, memory_order_acquire) > 0) {
+        ws_task *t = ws_pop(ws_self);
+        if (!t)
+            t = ws_steal_random(ws_self);
+        if (t)
+            ws_execute(t);
+    }
+}
+
+static void *ws_worker_loop(void *arg) {
+    ws_self = arg;
+    int misses = 0;
+    while (!atomic_load_explicit(&ws_rt.stop, memory_order_relaxed)) {
+        ws_task *t = ws_steal_random(ws_self);
+        if (t) {
+            ws_execute(t);
+            misses = 0;
+        } else if (++misses > 64) {
+            sched_yield();   // nothing around: let someone else have the core
+            misses = 0;
+        }
+    }
+    return NULL;
+}
+
+// Start num_threads workers, counting the calling thread as worker 0
+static inline void ws_init(int num_threads) {
+    if (num_threads < 1)
+        num_threads = 1;
+    if (num_threads > WS_MAX_WORKERS)
+        num_threads = WS_MAX_WORKERS;
+
+    ws_rt.workers = aligned_alloc(_Alignof(ws_worker), num_threads * sizeof(ws_worker));
+    if (!ws_rt.workers) {
+        fprintf(stderr, "ws_init: out of memory\n");
+        exit(1);
+    }
+    ws_rt.num_workers = num_threads;
+    atomic_store(&ws_rt.stop, 0);
+    for (int i = 0; i < num_threads; i++) {
+        ws_worker *w = &ws_rt.workers[i];
+        atomic_init(&w->top, 0);
+        atomic_init(&w->bottom, 0);
+        w->rng = 2463534242u + 7919u * i;
+        w->id = i;
+    }
+
+    ws_self = &ws_rt.workers[0];
+    for (int i = 1; i < num_threads; i++)
+        pthread_create(&ws_rt.threads[i], NULL, ws_worker_loop, &ws_rt.workers[i]);
+}
+
+// Call from worker 0 once all the work has been synced
+static inline void ws_shutdown(void) {
+    atomic_store(&ws_rt.stop, 1);
+    for (int i = 1; i < ws_rt.num_workers; i++)
+        pthread_join(ws_rt.threads[i], NULL);
+    free(ws_rt.workers);
+    ws_rt.workers = NULL;
+    ws_rt.num_workers = 0;
+    ws_self = NULL;
+}
+
+#endif